@@ -1,37 +1,91 @@
+#include "GroveOfflineSensor.h"
 #include "commandBase.h"
 #include <SoftwareSerial.h>
 extern CommandData commandData[];
 
+// Received bytes waiting to be parsed; no heap, so the sketch can run indefinitely
+static const uint8_t RING_SIZE = 32;  // Power of two
+static uint8_t ring[RING_SIZE];
+static uint8_t ringHead = 0;    // Oldest byte
+static uint8_t ringCount = 0;
+static unsigned long lastByteTime = 0;
+static VoiceParserStats stats = {0, 0, 0};
 
-String getCommandInString(uint8_t* hexCode) {
-  //Extract the second element from the input hex code
+
+const char* getCommandInString(uint8_t commandCode) {
   // Find the command with the given dynamic hex code
   for (int i = 0; i < numCommands; i++) {
-   //  Compare dynamic hex codes
-    if (hexCode[1] == commandData[i].dynamicHexCode) {
+    if (commandCode == commandData[i].dynamicHexCode) {
       // Return the corresponding response
       return commandData[i].reply;
     }
- 
   }
-   // If no match is found, return an empty string or an error message
+  // If no match is found, return an error message
   return "Command not found, improper Hex code found";
 }
 
+const VoiceParserStats& getVoiceParserStats() {
+  return stats;
+}
+
+static uint8_t ringAt(uint8_t offset) {
+  return ring[(ringHead + offset) & (RING_SIZE - 1)];
+}
+
+static void ringDrop(uint8_t count) {
+  ringHead = (ringHead + count) & (RING_SIZE - 1);
+  ringCount -= count;
+}
+
+// Function to move the bytes the serial port holds into the ring, as far as they fit
+static void fillRing(SoftwareSerial *groveSerial) {
+  while (ringCount < RING_SIZE && groveSerial->available() > 0) {
+    int value = groveSerial->read();
+    if (value < 0) break;
+    ring[(ringHead + ringCount) & (RING_SIZE - 1)] = (uint8_t)value;
+    ringCount++;
+    lastByteTime = millis();
+  }
+}
+
 
+bool detectVoiceFromGroveSensor(SoftwareSerial *groveSerial, VoiceEvent &event) {
+  fillRing(groveSerial);
+
+  // A frame is sent in one burst; a stale partial one would corrupt the next frame
+  if (ringCount > 0 && ringCount < VOICE_FRAME_LENGTH && millis() - lastByteTime > VOICE_FRAME_TIMEOUT_MS) {
+    ringDrop(ringCount);
+    stats.timeouts++;
+    return false;
+  }
 
-uint8_t* detectVoiceFromGroveSensor(SoftwareSerial *groveSerial) {
-  uint8_t *receivedData = new uint8_t[5];
+  while (ringCount > 0) {
+    // Resynchronise: skip bytes until a frame header
+    if (ringAt(0) != VOICE_FRAME_HEADER) {
+      ringDrop(1);
+      stats.resyncs++;
+      continue;
+    }
+    if (ringCount < VOICE_FRAME_LENGTH) {
+      return false;  // Wait for the rest of the frame
+    }
 
-  if (groveSerial->available()) {
-    // Read data from SoftwareSerial
-    for (int i = 0; i < 5; i++) {
-      receivedData[i] = groveSerial->read();
+    uint8_t checksum = 0;
+    for (uint8_t i = 0; i < VOICE_FRAME_LENGTH - 1; i++) {
+      checksum += ringAt(i);
     }
-    // Return a pointer to the dynamically allocated data array
-    return receivedData;
+    if (checksum != ringAt(VOICE_FRAME_LENGTH - 1)) {
+      // False header inside other data, look for the next one
+      ringDrop(1);
+      stats.resyncs++;
+      continue;
+    }
+
+    event.commandCode = ringAt(1);
+    event.reply = getCommandInString(event.commandCode);
+    ringDrop(VOICE_FRAME_LENGTH);
+    stats.frames++;
+    return true;
   }
-  // If there is not enough data available, return NULL
-  delete[] receivedData; // Free the memory before returning NULL
-  return NULL;
+  return false;
 }
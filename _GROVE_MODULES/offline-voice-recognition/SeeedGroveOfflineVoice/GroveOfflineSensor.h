@@ -1,14 +1,34 @@
-
-
 #ifndef GROVEOFFLINESENSOR_H
 #define GROVEOFFLINESENSOR_H
 
 #include <Arduino.h>
 #include <SoftwareSerial.h>
 
+// The sensor sends one 5-byte frame per recognised command:
+// 0x5A, command code, 0x00, 0x00, checksum (low byte of the sum of the first four)
+const uint8_t VOICE_FRAME_HEADER = 0x5A;
+const uint8_t VOICE_FRAME_LENGTH = 5;
+const unsigned long VOICE_FRAME_TIMEOUT_MS = 50; // A partial frame older than this is dropped
+
+// A complete, checked command from the sensor
+struct VoiceEvent {
+  uint8_t commandCode;
+  const char* reply;
+};
+
+// Parser statistics
+struct VoiceParserStats {
+  uint32_t frames;     // Complete frames with a valid checksum
+  uint32_t resyncs;    // Bytes skipped to find the next frame header
+  uint32_t timeouts;   // Partial frames dropped after VOICE_FRAME_TIMEOUT_MS
+};
+
+// Reads whatever bytes are waiting without blocking and returns true with the next
+// complete command in event. Call from loop() until it returns false.
+bool detectVoiceFromGroveSensor(SoftwareSerial *groveSerial, VoiceEvent &event);
 
-uint8_t* detectVoiceFromGroveSensor(SoftwareSerial *groveSerial);
+const char* getCommandInString(uint8_t commandCode);
 
-String getCommandInString(uint8_t* inputHexCode);
+const VoiceParserStats& getVoiceParserStats();
 
 #endif
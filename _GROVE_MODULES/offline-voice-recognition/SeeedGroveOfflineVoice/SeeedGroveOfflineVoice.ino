@@ -13,12 +13,10 @@ void setup() {
 }
 
 void loop() {
-  // Your main code here
-   uint8_t *voiceData = detectVoiceFromGroveSensor(&groveSerial);
-
-  if(voiceData != NULL){
-    String response = getCommandInString(voiceData);
-    Serial.println(response);
+  // Handle every complete command received since the last loop; the parser never
+  // blocks, so other work can run here as well
+  VoiceEvent voiceEvent;
+  while (detectVoiceFromGroveSensor(&groveSerial, voiceEvent)) {
+    Serial.println(voiceEvent.reply);
   }
-  delay(1000);
 }
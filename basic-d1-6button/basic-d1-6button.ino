@@ -1,43 +1,32 @@
 #include "pin_definitions.h"
+#include "input_manager.h"
 
-// Variables to store button states
-int buttonStates[numButtons] = {0};
-int lastButtonStates[numButtons] = {0};
-unsigned long lastDebounceTimes[numButtons] = {0};
-unsigned long lastDebugTime = 0;
+// All six buttons, in button order - masks and bit positions are computed at compile time
+typedef InputManager<button1Pin, button2Pin, button3Pin, button4Pin, button5Pin, button6Pin> ButtonInputs;
+ButtonInputs buttons;
 bool hardwareTestMode = false;  // Temporarily disabled for debugging
 
+// Function to report a debounced button change
+void handleButtonChange(uint8_t index, bool pressed) {
+  Serial.print("Button ");
+  Serial.print(index + 1);
+  Serial.println(pressed ? " pressed" : " released");
+}
+
 void setup() {
   // Initialize serial communication
   Serial.begin(9600);
   Serial.println("\n\n=== 6-Button Controller Setup ===");
   
-  // Set all button pins as inputs (using external pull-down resistors)
-  pinMode(button1Pin, INPUT);
-  pinMode(button2Pin, INPUT);
-  pinMode(button3Pin, INPUT);
-  pinMode(button4Pin, INPUT);
-  pinMode(button5Pin, INPUT);
-  pinMode(button6Pin, INPUT);
+  // Set all button pins as inputs (using external pull-down resistors);
+  // buttons read HIGH when pressed, so they are not active-low
+  buttons.begin(INPUT, false, debounceTime);
   
   Serial.println("All buttons initialized");
   Serial.println("Starting main loop...");
 }
 
 void loop() {
-  // Simple continuous reading of all buttons
-  Serial.print("Button States: ");
-  Serial.print(digitalRead(button1Pin));
-  Serial.print(" ");
-  Serial.print(digitalRead(button2Pin));
-  Serial.print(" ");
-  Serial.print(digitalRead(button3Pin));
-  Serial.print(" ");
-  Serial.print(digitalRead(button4Pin));
-  Serial.print(" ");
-  Serial.print(digitalRead(button5Pin));
-  Serial.print(" ");
-  Serial.println(digitalRead(button6Pin));
-  
-  delay(100);  // Small delay to prevent overwhelming the serial output
-}
\ No newline at end of file
+  // Scan all buttons at once and only report changes
+  buttons.update(handleButtonChange);
+}
@@ -0,0 +1,105 @@
+#ifndef BUTTON_SCANNER_H
+#define BUTTON_SCANNER_H
+
+#include <Arduino.h>
+
+// Parallel button scanner.
+// All buttons are sampled with one read of the GPIO input register(s) and debounced
+// together with 2-bit vertical counters: each bit position is an independent counter,
+// so one scan costs the same handful of bitwise operations for 1 or 32 buttons.
+// A bit only changes state after it has differed for 4 consecutive scans.
+// InputManager (input_manager.h) builds the pin list on top of this at compile time.
+
+// Function to read every scannable input into one 32-bit word
+// ESP8266: bit n = GPIOn (GPIO0-15 from GPI, GPIO16 from the RTC register)
+// ESP32:   bit n = GPIOn (GPIO0-27), bits 28-31 = GPIO32-35 (GPIO28-31 do not exist)
+// Other ESP32 variants: bit n = GPIOn (GPIO0-31)
+// Mega2560: ports A, C, L, K packed as bytes 0-3 (pins 22-29, 37-30, 49-42, A8-A15)
+inline uint32_t readButtonInputs() {
+  #if defined(ARDUINO_ARCH_ESP8266)
+    return GPI | ((uint32_t)(GP16I & 0x01) << 16);
+  #elif defined(CONFIG_IDF_TARGET_ESP32)
+    return (REG_READ(GPIO_IN_REG) & 0x0FFFFFFF) | ((REG_READ(GPIO_IN1_REG) & 0x0F) << 28);
+  #elif defined(ESP32)
+    return REG_READ(GPIO_IN_REG);
+  #elif defined(__AVR_ATmega2560__)
+    return (uint32_t)PINA | ((uint32_t)PINC << 8) | ((uint32_t)PINL << 16) | ((uint32_t)PINK << 24);
+  #else
+    #error "readButtonInputs() is not implemented for this board"
+  #endif
+}
+
+// Bit a pin occupies in readButtonInputs(), or -1 if it cannot be scanned
+constexpr int scanBitForPin(int pin) {
+  #if defined(__AVR_ATmega2560__)
+    return (pin >= 22 && pin <= 29) ? pin - 22 :        // PA0-PA7
+           (pin >= 30 && pin <= 37) ? 8 + (37 - pin) :  // PC0-PC7
+           (pin >= 42 && pin <= 49) ? 16 + (49 - pin) : // PL0-PL7
+           (pin >= 62 && pin <= 69) ? 24 + (pin - 62) : // PK0-PK7 (A8-A15)
+           -1;
+  #elif defined(ARDUINO_ARCH_ESP8266)
+    return (pin >= 0 && pin <= 16) ? pin : -1;
+  #elif defined(CONFIG_IDF_TARGET_ESP32)
+    return (pin >= 0 && pin < 28) ? pin : (pin >= 32 && pin <= 35) ? pin - 4 : -1;
+  #else
+    return (pin >= 0 && pin < 32) ? pin : -1;
+  #endif
+}
+
+// Checks of the pin-to-bit table against the register layout above
+#if defined(__AVR_ATmega2560__)
+  static_assert(scanBitForPin(22) == 0 && scanBitForPin(29) == 7, "PORTA maps to bits 0-7");
+  static_assert(scanBitForPin(37) == 8 && scanBitForPin(30) == 15, "PORTC maps to bits 8-15");
+  static_assert(scanBitForPin(49) == 16 && scanBitForPin(42) == 23, "PORTL maps to bits 16-23");
+  static_assert(scanBitForPin(62) == 24 && scanBitForPin(69) == 31, "PORTK maps to bits 24-31");
+  static_assert(scanBitForPin(13) == -1 && scanBitForPin(38) == -1, "pins outside A/C/L/K are not scannable");
+#elif defined(ARDUINO_ARCH_ESP8266)
+  static_assert(scanBitForPin(0) == 0 && scanBitForPin(16) == 16, "GPIO16 comes from the RTC register");
+  static_assert(scanBitForPin(17) == -1, "the ESP8266 has no GPIO17");
+#elif defined(CONFIG_IDF_TARGET_ESP32)
+  static_assert(scanBitForPin(27) == 27 && scanBitForPin(32) == 28 && scanBitForPin(35) == 31,
+                "GPIO32-35 map to bits 28-31");
+  static_assert(scanBitForPin(28) == -1 && scanBitForPin(36) == -1, "GPIO28-31 and 36+ are not scannable");
+#endif
+
+class ButtonScanner {
+private:
+  uint32_t mask;        // Scanned bits
+  uint32_t invertMask;  // Bits that read LOW when pressed
+  uint32_t state;       // Debounced pressed state, 1 = pressed
+  uint32_t count0;      // Vertical counter, low bit
+  uint32_t count1;      // Vertical counter, high bit
+
+public:
+  ButtonScanner() : mask(0), invertMask(0), state(0), count0(0), count1(0) {}
+
+  // Start scanning the bits in scanMask; bits in activeLowMask are pressed when LOW
+  void begin(uint32_t scanMask, uint32_t activeLowMask) {
+    mask = scanMask;
+    invertMask = activeLowMask & scanMask;
+    state = (readButtonInputs() ^ invertMask) & mask;
+    count0 = 0;
+    count1 = 0;
+  }
+
+  // Function to scan all buttons once, returns the mask of bits whose debounced state changed
+  uint32_t scan() {
+    uint32_t sample = (readButtonInputs() ^ invertMask) & mask;
+    uint32_t delta = sample ^ state;
+
+    // Count consecutive differing samples per bit, reset bits that agree
+    count1 = (count1 ^ count0) & delta;
+    count0 = ~count0 & delta;
+
+    // Bits that have differed for 4 scans roll the counter over and toggle
+    uint32_t toggle = delta & ~(count0 | count1);
+    state ^= toggle;
+    return toggle;
+  }
+
+  uint32_t pressedMask() const {
+    return state;
+  }
+};
+
+#endif // BUTTON_SCANNER_H
@@ -2,14 +2,23 @@
 #include "pin_definitions.h"
 #include "wifi_setup.h"
 #include "mqtt_handler.h"
+#include "input_manager.h"
 
 // Create NeoPixel object
 Adafruit_NeoPixel pixels(numPixels, neoPixelPin, NEO_GRB + NEO_KHZ800);
 
-// Variable to store the button state
-int buttonState = 0;
-// Variable to track last button press time
-unsigned long lastButtonPress = 0;
+// Button input, debounced by 4 stable scans
+const unsigned long debounceTime = 50;  // milliseconds
+InputManager<buttonPin> button;
+
+// Function to handle a debounced button change
+void handleButtonChange(uint8_t index, bool pressed) {
+  if (pressed) {
+    Serial.println("Button pressed!");
+    // Publish button press event
+    publishMessage("PRESSED");
+  }
+}
 
 void setup() {
   // Initialize serial communication at 115200 baud rate
@@ -31,8 +40,8 @@ void setup() {
   Serial.printf("Number of Pixels: %d\n", numPixels);
   Serial.printf("Brightness: %d\n", brightness);
   
-  // Set the button pin as input (using external pull-down resistor)
-  pinMode(buttonPin, INPUT);
+  // Set the button pin as input (using external pull-down resistor, HIGH when pressed)
+  button.begin(INPUT, false, debounceTime);
   Serial.println("Button pin set as INPUT");
   
   // Set the LED pin as output
@@ -81,16 +90,6 @@ void loop() {
   // Handle MQTT connection and messages
   mqttLoop();
 
-  // Read the state of the button
-  buttonState = digitalRead(buttonPin);
-  
-  // With pull-down resistor, the button will read HIGH when pressed
-  if (buttonState == HIGH && (millis() - lastButtonPress > 200)) {  // Debounce check
-    lastButtonPress = millis();
-    Serial.println("Button pressed!");
-    // Publish button press event
-    publishMessage("PRESSED");
-    // Add a small delay to prevent multiple readings
-    delay(100);
-  }
+  // Scan the button and handle presses
+  button.update(handleButtonChange);
 }
\ No newline at end of file
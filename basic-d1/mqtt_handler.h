@@ -4,6 +4,7 @@
 #include <PubSubClient.h>
 #include "wifi_setup.h"
 #include "pin_definitions.h"
+#include "pixel_commands.h"
 
 // MQTT Broker configuration
 const char* mqtt_server = "192.168.100.1";  // Update to match your MQTT broker's IP on the 192.168.100.x network
@@ -35,8 +36,19 @@ PubSubClient client(espClient);
 // Forward declaration of the NeoPixel object
 extern Adafruit_NeoPixel pixels;
 
+void publishMessage(const char* message);
+
 // Callback function for received MQTT messages
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
+  // Multi-pixel commands (see pixel_commands.h), binary ones are not printable
+  if (isBinaryPixelCommand(payload, length) || isTextPixelCommand(payload, length)) {
+    if (!applyPixelCommands(payload, length)) {
+      Serial.println("Invalid pixel command");
+      publishMessage("Invalid pixel command");
+    }
+    return;
+  }
+
   Serial.print("Message arrived [");
   Serial.print(topic);
   Serial.print("] ");
@@ -129,6 +141,9 @@ void reconnectMQTT() {
 void setupMQTT() {
   client.setServer(mqtt_server, mqtt_port);
   client.setCallback(mqttCallback);
+  // Default 256-byte buffer only fits about 76 pixels of a batch command;
+  // a longer message is silently dropped by PubSubClient
+  client.setBufferSize(PIXEL_MESSAGE_MAX + 64);
 }
 
 // Function to maintain MQTT connection and handle messages
@@ -0,0 +1,255 @@
+#ifndef PIXEL_COMMANDS_H
+#define PIXEL_COMMANDS_H
+
+#include <Adafruit_NeoPixel.h>
+#include "pin_definitions.h"
+
+// Multi-pixel colour commands.
+// A message holds any number of commands; they are all applied to the pixel buffer
+// and sent to the strip with a single pixels.show(). Every message is checked in full
+// before anything is applied, so an invalid message leaves the pixels unchanged.
+//
+// Text form, commands separated by ';', colours as RRGGBB hex:
+//   PX:<index>:<RRGGBB>                 set one pixel
+//   RANGE:<first>-<last>:<RRGGBB>       set pixels first..last
+//   FILL:<RRGGBB>                       set every pixel
+//   HSV:<hue 0-65535>,<sat>,<val>       set every pixel from HSV
+//   BRIGHT:<0-255>                      global brightness
+//   HEX:<first>:<RRGGBB><RRGGBB>...     set consecutive pixels from first
+//   e.g. "FILL:000000;PX:0:FF8000;BRIGHT:40"
+//
+// Binary form, a message starting with a byte >= 0x80, records back to back:
+//   0x81 index r g b                    set one pixel
+//   0x82 first count r g b              set count pixels from first
+//   0x83 r g b                          set every pixel
+//   0x84 hueHigh hueLow sat val         set every pixel from HSV
+//   0x85 brightness                     global brightness
+//   0x86 first count (r g b) x count    set consecutive pixels from first
+//   index, first and count are one byte, so binary commands reach pixels 0-255 only.
+
+enum PixelOpcode : uint8_t {
+  PIXEL_OP_SET = 0x81,
+  PIXEL_OP_RANGE = 0x82,
+  PIXEL_OP_FILL = 0x83,
+  PIXEL_OP_HSV = 0x84,
+  PIXEL_OP_BRIGHTNESS = 0x85,
+  PIXEL_OP_BATCH = 0x86
+};
+
+// Longest message painting the whole strip: text "HEX:0:" plus 6 hex digits per pixel
+// (the binary 0x86 form needs 3 bytes per pixel). The MQTT buffer is sized from this.
+const size_t PIXEL_MESSAGE_MAX = 6 + numPixels * 6;
+static_assert(PIXEL_MESSAGE_MAX + 64 <= 65535, "numPixels too large for the MQTT buffer (16-bit size)");
+
+extern Adafruit_NeoPixel pixels;
+
+// Function to parse a hex digit, -1 if invalid
+int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Function to parse an RRGGBB colour at text, returns false if invalid
+bool parseHexColor(const char* text, uint32_t& color) {
+  color = 0;
+  for (int i = 0; i < 6; i++) {
+    int digit = hexDigit(text[i]);
+    if (digit < 0) return false;
+    color = (color << 4) | digit;
+  }
+  return true;
+}
+
+// Function to parse a decimal number up to max from text..end, advancing text;
+// returns false if invalid. Never reads past end (MQTT payloads are not terminated).
+bool parseNumber(const char*& text, const char* end, long max, long& value) {
+  const char* start = text;
+  value = 0;
+  while (text < end && *text >= '0' && *text <= '9') {
+    value = value * 10 + (*text - '0');
+    if (value > max) return false;
+    text++;
+  }
+  return text > start;
+}
+
+// Function to consume the character c at text, returns false if it is not there
+bool expectChar(const char*& text, const char* end, char c) {
+  if (text >= end || *text != c) return false;
+  text++;
+  return true;
+}
+
+// Function to parse an RRGGBB colour that must fill the rest of the command
+bool parseFinalColor(const char* text, const char* end, uint32_t& color) {
+  return end - text == 6 && parseHexColor(text, color);
+}
+
+void fillPixels(uint32_t color, bool apply, int first = 0, int count = numPixels) {
+  if (apply) {
+    pixels.fill(color, first, count);
+  }
+}
+
+// Function to run one text command of length bytes, applying it only if apply.
+// Parsed in place, so a command can be as long as the MQTT buffer (PIXEL_MESSAGE_MAX).
+bool runTextCommand(const char* command, size_t length, bool apply) {
+  const char* end = command + length;
+  const char* p;
+  long first, last, value;
+  uint32_t color;
+
+  if (length >= 3 && memcmp(command, "PX:", 3) == 0) {
+    p = command + 3;
+    if (!parseNumber(p, end, numPixels - 1, first) || !expectChar(p, end, ':')) return false;
+    if (!parseFinalColor(p, end, color)) return false;
+    if (apply) pixels.setPixelColor(first, color);
+    return true;
+  }
+  if (length >= 6 && memcmp(command, "RANGE:", 6) == 0) {
+    p = command + 6;
+    if (!parseNumber(p, end, numPixels - 1, first) || !expectChar(p, end, '-')) return false;
+    if (!parseNumber(p, end, numPixels - 1, last) || last < first || !expectChar(p, end, ':')) return false;
+    if (!parseFinalColor(p, end, color)) return false;
+    fillPixels(color, apply, first, last - first + 1);
+    return true;
+  }
+  if (length >= 5 && memcmp(command, "FILL:", 5) == 0) {
+    if (!parseFinalColor(command + 5, end, color)) return false;
+    fillPixels(color, apply);
+    return true;
+  }
+  if (length >= 4 && memcmp(command, "HSV:", 4) == 0) {
+    long hue, sat, val;
+    p = command + 4;
+    if (!parseNumber(p, end, 65535, hue) || !expectChar(p, end, ',')) return false;
+    if (!parseNumber(p, end, 255, sat) || !expectChar(p, end, ',')) return false;
+    if (!parseNumber(p, end, 255, val) || p != end) return false;
+    fillPixels(Adafruit_NeoPixel::ColorHSV(hue, sat, val), apply);
+    return true;
+  }
+  if (length >= 7 && memcmp(command, "BRIGHT:", 7) == 0) {
+    p = command + 7;
+    if (!parseNumber(p, end, 255, value) || p != end) return false;
+    if (apply) pixels.setBrightness(value);
+    return true;
+  }
+  if (length >= 4 && memcmp(command, "HEX:", 4) == 0) {
+    p = command + 4;
+    if (!parseNumber(p, end, numPixels - 1, first) || !expectChar(p, end, ':')) return false;
+    size_t digits = end - p;
+    if (digits == 0 || digits % 6 != 0 || first + (long)(digits / 6) > numPixels) return false;
+    for (size_t i = 0; i < digits / 6; i++) {
+      if (!parseHexColor(p + i * 6, color)) return false;
+      if (apply) pixels.setPixelColor(first + i, color);
+    }
+    return true;
+  }
+  return false;
+}
+
+// Function to run the binary records in data, applying them only if apply
+bool runBinaryCommands(const uint8_t* data, size_t length, bool apply) {
+  size_t i = 0;
+  while (i < length) {
+    uint8_t opcode = data[i++];
+    const uint8_t* args = data + i;
+    size_t remaining = length - i;
+
+    switch (opcode) {
+      case PIXEL_OP_SET:
+        if (remaining < 4 || args[0] >= numPixels) return false;
+        if (apply) pixels.setPixelColor(args[0], args[1], args[2], args[3]);
+        i += 4;
+        break;
+      case PIXEL_OP_RANGE:
+        if (remaining < 5 || args[1] == 0 || args[0] + args[1] > numPixels) return false;
+        fillPixels(Adafruit_NeoPixel::Color(args[2], args[3], args[4]), apply, args[0], args[1]);
+        i += 5;
+        break;
+      case PIXEL_OP_FILL:
+        if (remaining < 3) return false;
+        fillPixels(Adafruit_NeoPixel::Color(args[0], args[1], args[2]), apply);
+        i += 3;
+        break;
+      case PIXEL_OP_HSV:
+        if (remaining < 4) return false;
+        fillPixels(Adafruit_NeoPixel::ColorHSV((args[0] << 8) | args[1], args[2], args[3]), apply);
+        i += 4;
+        break;
+      case PIXEL_OP_BRIGHTNESS:
+        if (remaining < 1) return false;
+        if (apply) pixels.setBrightness(args[0]);
+        i += 1;
+        break;
+      case PIXEL_OP_BATCH: {
+        if (remaining < 2) return false;
+        size_t count = args[1];
+        if (count == 0 || args[0] + count > (size_t)numPixels || remaining < 2 + count * 3) return false;
+        if (apply) {
+          const uint8_t* rgb = args + 2;
+          for (size_t n = 0; n < count; n++, rgb += 3) {
+            pixels.setPixelColor(args[0] + n, rgb[0], rgb[1], rgb[2]);
+          }
+        }
+        i += 2 + count * 3;
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+// Function to run every ';'-separated text command in message, applying them only if apply
+bool runTextCommands(const char* message, size_t length, bool apply) {
+  size_t start = 0;
+  while (start < length) {
+    const char* separator = (const char*)memchr(message + start, ';', length - start);
+    size_t end = separator != nullptr ? (size_t)(separator - message) : length;
+    if (end > start && !runTextCommand(message + start, end - start, apply)) {
+      return false;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+// True if the payload uses the binary command form
+bool isBinaryPixelCommand(const uint8_t* payload, size_t length) {
+  return length > 0 && payload[0] >= 0x80;
+}
+
+// True if the payload starts with one of the text pixel commands
+bool isTextPixelCommand(const uint8_t* payload, size_t length) {
+  static const char* const prefixes[] = {"PX:", "RANGE:", "FILL:", "HSV:", "BRIGHT:", "HEX:"};
+  for (const char* prefix : prefixes) {
+    size_t prefixLength = strlen(prefix);
+    if (length >= prefixLength && memcmp(payload, prefix, prefixLength) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Function to validate and apply a pixel command message with one show(),
+// returns false (leaving the pixels unchanged) if any command is invalid
+bool applyPixelCommands(const uint8_t* payload, size_t length) {
+  bool binary = isBinaryPixelCommand(payload, length);
+  bool valid = binary ? runBinaryCommands(payload, length, false)
+                      : runTextCommands((const char*)payload, length, false);
+  if (!valid) return false;
+
+  if (binary) {
+    runBinaryCommands(payload, length, true);
+  } else {
+    runTextCommands((const char*)payload, length, true);
+  }
+  pixels.show();
+  return true;
+}
+
+#endif // PIXEL_COMMANDS_H
@@ -1,4 +1,5 @@
  #include <Adafruit_NeoPixel.h>
+#include "input_manager.h"
 
 // Button input on pin 13
 const int buttonPin = 13;
@@ -11,6 +12,21 @@ const int numPixels = 1;  // Number of NeoPixels
 // Brightness control (0-255)
 const int brightness = 20;  // 50% brightness
 
+// Button panel on ports A, C, L and K - list up to 32 pins in button order
+// Scannable pins: 22-29, 37-30, 49-42, A8-A15 (all read with one pass over the ports)
+// Buttons connect to GND and use the internal pull-ups
+typedef InputManager<22, 23, 24, 25, 26, 27, 28, 29,
+                     37, 36, 35, 34, 33, 32, 31, 30> PanelInputs;
+PanelInputs panel;
+const unsigned long PANEL_DEBOUNCE = 20;  // milliseconds, 4 stable scans
+
+// Function to report a debounced panel button change
+void handlePanelChange(uint8_t index, bool pressed) {
+  Serial.print("Panel button ");
+  Serial.print(index + 1);
+  Serial.println(pressed ? " pressed" : " released");
+}
+
 // Create NeoPixel object
 Adafruit_NeoPixel pixels(numPixels, neoPixelPin, NEO_GRB + NEO_KHZ800);
 
@@ -30,6 +46,9 @@ void setup() {
   // Set the LED pin as output
   pinMode(ledPin, OUTPUT);
   
+  // Enable pull-ups on every panel button and start scanning
+  panel.begin(INPUT_PULLUP, true, PANEL_DEBOUNCE);
+  
   // Initialize NeoPixel
   pixels.begin();
   pixels.setBrightness(brightness);  // Set the global brightness
@@ -37,6 +56,9 @@ void setup() {
 }
 
 void loop() {
+  // Scan the whole panel at once and report the buttons that changed
+  panel.update(handlePanelChange);
+  
   // Read the state of the button
   buttonState = digitalRead(buttonPin);
   
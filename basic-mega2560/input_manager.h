@@ -0,0 +1,115 @@
+#ifndef INPUT_MANAGER_H
+#define INPUT_MANAGER_H
+
+#include <Arduino.h>
+#include "button_scanner.h"
+
+// Compile-time button input manager.
+// The button pins are template arguments, so the scan mask and the pin-to-bit table
+// are constexpr and the dispatch loop unrolls to one bit test per button. Scanning and
+// the vertical-counter debounce are ButtonScanner's (button_scanner.h): a button only
+// changes after 4 consecutive differing scans.
+// No virtual calls and no heap. The handler is a template parameter: a lambda is
+// inlined into the loop, a plain function is called through a pointer.
+//
+//   InputManager<D1, D2, D5> buttons;
+//   buttons.begin(INPUT_PULLUP, true, 50);
+//   buttons.update([](uint8_t index, bool pressed) { ... });
+
+constexpr bool allPinsScannable() {
+  return true;
+}
+
+template <typename... Rest>
+constexpr bool allPinsScannable(int pin, Rest... rest) {
+  return scanBitForPin(pin) >= 0 && allPinsScannable(rest...);
+}
+
+template <int... Pins>
+class InputManager {
+public:
+  static const uint8_t COUNT = sizeof...(Pins);
+  static constexpr int PINS[COUNT] = {Pins...};
+  static constexpr uint8_t BITS[COUNT] = {(uint8_t)scanBitForPin(Pins)...};
+
+private:
+  static_assert(sizeof...(Pins) > 0, "InputManager needs at least one pin");
+  static_assert(allPinsScannable(Pins...), "InputManager pin cannot be read by readButtonInputs()");
+
+  ButtonScanner scanner;
+  unsigned long scanInterval;
+  unsigned long lastScan;
+
+public:
+  InputManager() : scanInterval(12), lastScan(0) {}
+
+  // Configure every pin; activeLow = pressed reads LOW. Debounce time is 4 scans.
+  void begin(uint8_t mode, bool activeLow, unsigned long debounceMs) {
+    for (uint8_t i = 0; i < COUNT; i++) {
+      pinMode(PINS[i], mode);
+    }
+    scanner.begin(mask(), activeLow ? mask() : 0);
+    scanInterval = debounceMs / 4;
+    lastScan = millis();
+  }
+
+  // Bits scanned for this pin list
+  static constexpr uint32_t mask() {
+    return maskOf(Pins...);
+  }
+
+  // Function to scan all buttons once, returns the scan-bit mask of buttons that changed
+  uint32_t scan() {
+    return scanner.scan();
+  }
+
+  // Function to scan when due and call handler(index, pressed) for each change
+  template <typename Handler>
+  void update(Handler handler) {
+    if (millis() - lastScan < scanInterval) return;
+    lastScan = millis();
+
+    uint32_t changed = scanner.scan();
+    if (changed == 0) return;
+
+    uint32_t state = scanner.pressedMask();
+    for (uint8_t i = 0; i < COUNT; i++) {
+      uint32_t bit = 1UL << BITS[i];
+      if (changed & bit) {
+        handler(i, (state & bit) != 0);
+      }
+    }
+  }
+
+  bool isPressed(uint8_t index) const {
+    return (scanner.pressedMask() >> BITS[index]) & 1;
+  }
+
+  // Pressed buttons as a mask of button indexes (bit 0 = first pin)
+  uint32_t pressedButtons() const {
+    uint32_t state = scanner.pressedMask();
+    uint32_t result = 0;
+    for (uint8_t i = 0; i < COUNT; i++) {
+      if ((state >> BITS[i]) & 1) {
+        result |= 1UL << i;
+      }
+    }
+    return result;
+  }
+
+private:
+  static constexpr uint32_t maskOf() {
+    return 0;
+  }
+
+  template <typename... Rest>
+  static constexpr uint32_t maskOf(int pin, Rest... rest) {
+    return (1UL << scanBitForPin(pin)) | maskOf(rest...);
+  }
+};
+
+// Out-of-class definitions for the constexpr tables (needed before C++17)
+template <int... Pins> constexpr int InputManager<Pins...>::PINS[];
+template <int... Pins> constexpr uint8_t InputManager<Pins...>::BITS[];
+
+#endif // INPUT_MANAGER_H
@@ -1,14 +1,11 @@
 #include <Adafruit_NeoPixel.h>
 #include "wifi_setup.h"
 #include "mqtt_handler.h"
+#include "web_server.h"
 #include "pin_definitions.h"
 
-// Define the pin connected to the NeoPixels
-const int RING_COUNT = 9;
-const int ring_counts[RING_COUNT] = {60, 48, 40, 32, 24, 16, 12, 8, 1};
-
 // Create NeoPixel object
-Adafruit_NeoPixel strip(241, neoPixelPin, NEO_GRB + NEO_KHZ800);  // Total of 241 LEDs
+Adafruit_NeoPixel strip(TOTAL_PIXELS, neoPixelPin, NEO_GRB + NEO_KHZ800);  // Total of 241 LEDs
 
 void setup() {
   // Initialize Serial for debugging
@@ -25,14 +22,25 @@ void setup() {
   // Setup MQTT
   setupMQTT();
   
+  // Setup Web Server
+  setupWebServer();
+  
+  // Listen for the binary frame stream over UDP
+  setupFrameStream();
+  
+  // Network time for synchronised effect starts
+  setupTimeSync();
+  
   // Initialize the NeoPixel strip
   Serial.println("Initializing NeoPixel strip...");
   strip.begin();
+  // Hand frames to the RMT peripheral instead of the blocking show()
+  setupLedOutput(neoPixelPin);
   // Set all pixels to off
   strip.clear();
-  strip.show();
+  showFrame();
   // Set brightness (0-255)
-  strip.setBrightness(255);  // Set to maximum brightness for testing
+  strip.setBrightness(255);  // Full range, the power budget in pixel_power.h limits the current
   Serial.println("NeoPixel strip initialized");
   Serial.println("=====================\n");
 }
@@ -45,4 +53,19 @@ void loop() {
   
   // Handle MQTT connection and messages
   mqttLoop();
+  
+  // Keep the network clock in sync
+  timeSyncLoop();
+  
+  // Handle frame uploads over HTTP
+  handleWebServer();
+  
+  // Apply streamed frames received over UDP
+  handleFrameStream();
+  
+  // Render the next animation frame when one is due
+  animationLoop();
+  
+  // Send a frame that was held back while both LED buffers were busy
+  commitRings();
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#ifndef FRAME_STREAM_H
+#define FRAME_STREAM_H
+
+#include <Adafruit_NeoPixel.h>
+#include <WiFiUdp.h>
+#include "ring_layout.h"
+#include "led_output.h"
+#include "ring_frame.h"
+#include "ring_animation.h"
+
+// Binary frame stream, received over MQTT or UDP.
+// Packet: 8-byte header followed by the pixel payload
+//   byte 0    magic 0xA5
+//   byte 1    type: 0 = raw keyframe, 1 = RLE keyframe, 2 = RLE XOR delta
+//   byte 2-3  sequence number (little-endian), wraps at 65535
+//   byte 4-5  base sequence - the frame a delta applies to (ignored for keyframes)
+//   byte 6-7  pixel count, must be TOTAL_PIXELS
+// RLE payload: a control byte c, then
+//   c < 0x80   (c + 1) literal pixels follow, 3 bytes (R, G, B) each
+//   c >= 0x80  one pixel follows, repeated (c - 0x7F) times
+// A delta's pixels are XORed onto the base frame, so unchanged pixels are zero and
+// collapse into long runs. Frames older than the last applied one are dropped, and a
+// delta whose base is not the frame on the strip is dropped until the next keyframe.
+// A keyframe with sequence 0, or one far behind the frame on the strip, always applies:
+// a restarted sender is picked up at its first keyframe that arrives, even if the
+// sequence 0 packet was lost.
+// tools/led_stream.py is the matching encoder.
+
+const uint8_t STREAM_MAGIC = 0xA5;
+const uint8_t STREAM_HEADER_BYTES = 8;
+const uint16_t STREAM_UDP_PORT = 7777;
+const int16_t STREAM_RESYNC_WINDOW = 256;  // Older keyframes are taken as a sender restart
+const size_t STREAM_MAX_PACKET = STREAM_HEADER_BYTES + FRAME_BYTES + (TOTAL_PIXELS + 127) / 128;
+
+enum StreamFrameType : uint8_t {
+  STREAM_KEYFRAME_RAW = 0,
+  STREAM_KEYFRAME_RLE = 1,
+  STREAM_DELTA_RLE = 2
+};
+
+// Stream statistics
+struct StreamStats {
+  uint32_t received;
+  uint32_t applied;
+  uint32_t stale;       // Older than the frame on the strip
+  uint32_t noBase;      // Delta whose base frame is not on the strip
+  uint32_t invalid;     // Bad header or payload
+};
+
+StreamStats streamStats = {0, 0, 0, 0, 0};
+
+uint8_t streamFrame[FRAME_BYTES];     // Frame currently on the strip (RGB)
+uint8_t streamScratch[FRAME_BYTES];   // Frame being decoded
+uint16_t streamSequence = 0;
+bool streamHasFrame = false;
+
+WiFiUDP streamUdp;
+uint8_t streamPacket[STREAM_MAX_PACKET];
+
+// Function to decode an RLE payload into exactly FRAME_BYTES, XORed onto out if xorMode
+bool decodeStreamRle(const uint8_t* data, size_t length, uint8_t* out, bool xorMode) {
+  size_t in = 0;
+  size_t pixel = 0;
+
+  while (in < length) {
+    uint8_t control = data[in++];
+    if (control < 0x80) {
+      size_t count = control + 1;
+      if (pixel + count > TOTAL_PIXELS || in + count * 3 > length) return false;
+      for (size_t i = 0; i < count * 3; i++) {
+        out[pixel * 3 + i] = xorMode ? out[pixel * 3 + i] ^ data[in + i] : data[in + i];
+      }
+      in += count * 3;
+      pixel += count;
+    } else {
+      size_t count = control - 0x7F;
+      if (pixel + count > TOTAL_PIXELS || in + 3 > length) return false;
+      const uint8_t* rgb = data + in;
+      for (size_t i = 0; i < count; i++, pixel++) {
+        uint8_t* p = out + pixel * 3;
+        if (xorMode) {
+          p[0] ^= rgb[0];
+          p[1] ^= rgb[1];
+          p[2] ^= rgb[2];
+        } else {
+          p[0] = rgb[0];
+          p[1] = rgb[1];
+          p[2] = rgb[2];
+        }
+      }
+      in += 3;
+    }
+  }
+  return pixel == TOTAL_PIXELS;
+}
+
+// Function to decode and show one stream packet, returns true if it was applied
+bool applyStreamPacket(const uint8_t* packet, size_t length) {
+  streamStats.received++;
+  if (length < STREAM_HEADER_BYTES || packet[0] != STREAM_MAGIC ||
+      (packet[6] | (packet[7] << 8)) != TOTAL_PIXELS) {
+    streamStats.invalid++;
+    return false;
+  }
+
+  uint8_t type = packet[1];
+  uint16_t sequence = packet[2] | (packet[3] << 8);
+  uint16_t base = packet[4] | (packet[5] << 8);
+  const uint8_t* payload = packet + STREAM_HEADER_BYTES;
+  size_t payloadLength = length - STREAM_HEADER_BYTES;
+
+  // Drop frames that are not newer than the one on the strip (wrap-around safe).
+  // A late packet is only a few frames old; a keyframe far behind comes from a sender
+  // that restarted its counter, so it resynchronises instead.
+  int16_t age = (int16_t)(sequence - streamSequence);
+  bool restart = type != STREAM_DELTA_RLE && (sequence == 0 || age < -STREAM_RESYNC_WINDOW);
+  if (streamHasFrame && !restart && age <= 0) {
+    streamStats.stale++;
+    return false;
+  }
+
+  bool ok;
+  switch (type) {
+    case STREAM_KEYFRAME_RAW:
+      ok = payloadLength == FRAME_BYTES;
+      if (ok) memcpy(streamScratch, payload, FRAME_BYTES);
+      break;
+    case STREAM_KEYFRAME_RLE:
+      ok = decodeStreamRle(payload, payloadLength, streamScratch, false);
+      break;
+    case STREAM_DELTA_RLE:
+      if (!streamHasFrame || base != streamSequence) {
+        streamStats.noBase++;
+        return false;
+      }
+      memcpy(streamScratch, streamFrame, FRAME_BYTES);
+      ok = decodeStreamRle(payload, payloadLength, streamScratch, true);
+      break;
+    default:
+      ok = false;
+      break;
+  }
+  if (!ok) {
+    streamStats.invalid++;
+    return false;
+  }
+
+  stopAnimation();
+  memcpy(streamFrame, streamScratch, FRAME_BYTES);
+  streamSequence = sequence;
+  streamHasFrame = true;
+
+  for (int i = 0; i < TOTAL_PIXELS; i++) {
+    const uint8_t* rgb = streamFrame + i * 3;
+    strip.setPixelColor(i, rgb[0], rgb[1], rgb[2]);
+  }
+  // Sent now, or by loop() once an LED buffer is free, so the strip always ends on
+  // the frame streamSequence refers to
+  ringsPending = true;
+  commitRings();
+  streamStats.applied++;
+  return true;
+}
+
+// Function to start listening for stream packets over UDP
+void setupFrameStream() {
+  streamUdp.begin(STREAM_UDP_PORT);
+  Serial.print("Frame stream listening on UDP port ");
+  Serial.println(STREAM_UDP_PORT);
+}
+
+// Function to apply any UDP stream packets that have arrived, call from loop()
+void handleFrameStream() {
+  int size;
+  while ((size = streamUdp.parsePacket()) > 0) {
+    if ((size_t)size > sizeof(streamPacket)) {
+      // The next parsePacket() discards the oversized packet
+      streamStats.received++;
+      streamStats.invalid++;
+      continue;
+    }
+    int length = streamUdp.read(streamPacket, sizeof(streamPacket));
+    if (length > 0) {
+      applyStreamPacket(streamPacket, length);
+    }
+  }
+}
+
+#endif // FRAME_STREAM_H
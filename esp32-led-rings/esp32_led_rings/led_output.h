@@ -0,0 +1,222 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <Adafruit_NeoPixel.h>
+#include <atomic>
+#include <esp_idf_version.h>
+#include "ring_layout.h"
+#include "pixel_power.h"
+
+// Asynchronous LED output.
+// Adafruit_NeoPixel stays the pixel buffer (setPixelColor, fill, brightness), but
+// instead of its blocking show() a frame is copied into one of two transmit buffers
+// and handed to the RMT peripheral, which clocks it out from interrupts while the CPU
+// carries on. With two buffers, one frame can be on the wire while the next is queued.
+// Callers check ledOutputReady() first and keep their frame pending while both buffers
+// are busy (see commitRings()), so the newest frame is sent once a buffer frees up. Gamma correction and
+// the power budget (pixel_power.h) are applied during the copy, so the strip buffer
+// always holds the uncorrected colours.
+// Needs the ESP-IDF 5 RMT driver (Arduino-ESP32 3.x); older cores fall back to
+// strip.show().
+#if ESP_IDF_VERSION_MAJOR >= 5
+  #define LED_OUTPUT_RMT 1
+  #include <driver/rmt_tx.h>
+  #include <driver/rmt_encoder.h>
+#else
+  #define LED_OUTPUT_RMT 0
+#endif
+
+extern Adafruit_NeoPixel strip;
+
+const uint32_t LED_RMT_RESOLUTION = 10000000;  // 10 MHz, 0.1 us per tick
+const uint32_t LED_RESET_US = 280;             // Latch time, WS2812B-V5 needs > 280 us
+
+// Output statistics
+uint32_t ledFramesShown = 0;    // Frames handed to the peripheral
+uint32_t ledFramesLate = 0;     // Frames queued behind one still on the wire
+uint32_t ledFramesDropped = 0;  // Frames refused: both buffers busy or transmit error
+
+#if LED_OUTPUT_RMT
+
+// Encoder that sends the pixel bytes followed by the reset (latch) pulse, so queued
+// frames are separated correctly even when sent back to back
+struct LedStripEncoder {
+  rmt_encoder_t base;
+  rmt_encoder_handle_t bytesEncoder;
+  rmt_encoder_handle_t copyEncoder;
+  int state;
+  rmt_symbol_word_t resetCode;
+};
+
+LedStripEncoder ledEncoder;
+rmt_channel_handle_t ledChannel = nullptr;
+uint8_t ledBuffers[2][FRAME_BYTES];
+uint8_t ledNextBuffer = 0;
+std::atomic<uint8_t> ledInFlight(0);
+
+size_t encodeLedStrip(rmt_encoder_t* encoder, rmt_channel_handle_t channel,
+                      const void* data, size_t size, rmt_encode_state_t* retState) {
+  LedStripEncoder* led = __containerof(encoder, LedStripEncoder, base);
+  rmt_encode_state_t session = RMT_ENCODING_RESET;
+  int state = RMT_ENCODING_RESET;
+  size_t symbols = 0;
+
+  if (led->state == 0) {
+    symbols += led->bytesEncoder->encode(led->bytesEncoder, channel, data, size, &session);
+    if (session & RMT_ENCODING_COMPLETE) {
+      led->state = 1;
+    }
+    if (session & RMT_ENCODING_MEM_FULL) {
+      *retState = (rmt_encode_state_t)(state | RMT_ENCODING_MEM_FULL);
+      return symbols;
+    }
+  }
+  if (led->state == 1) {
+    symbols += led->copyEncoder->encode(led->copyEncoder, channel, &led->resetCode,
+                                        sizeof(led->resetCode), &session);
+    if (session & RMT_ENCODING_COMPLETE) {
+      led->state = RMT_ENCODING_RESET;
+      state |= RMT_ENCODING_COMPLETE;
+    }
+    if (session & RMT_ENCODING_MEM_FULL) {
+      state |= RMT_ENCODING_MEM_FULL;
+    }
+  }
+  *retState = (rmt_encode_state_t)state;
+  return symbols;
+}
+
+esp_err_t resetLedStripEncoder(rmt_encoder_t* encoder) {
+  LedStripEncoder* led = __containerof(encoder, LedStripEncoder, base);
+  rmt_encoder_reset(led->bytesEncoder);
+  rmt_encoder_reset(led->copyEncoder);
+  led->state = RMT_ENCODING_RESET;
+  return ESP_OK;
+}
+
+esp_err_t deleteLedStripEncoder(rmt_encoder_t* encoder) {
+  LedStripEncoder* led = __containerof(encoder, LedStripEncoder, base);
+  rmt_del_encoder(led->bytesEncoder);
+  rmt_del_encoder(led->copyEncoder);
+  return ESP_OK;
+}
+
+// Transmit-done interrupt, frees a buffer
+bool IRAM_ATTR onLedFrameDone(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t* event, void* context) {
+  ledInFlight.fetch_sub(1, std::memory_order_release);
+  return false;
+}
+
+#endif // LED_OUTPUT_RMT
+
+// Function to setup the LED output on a pin, returns false if it falls back to show()
+bool setupLedOutput(int pin) {
+  #if LED_OUTPUT_RMT
+    rmt_tx_channel_config_t channelConfig = {};
+    channelConfig.gpio_num = (gpio_num_t)pin;
+    channelConfig.clk_src = RMT_CLK_SRC_DEFAULT;
+    channelConfig.resolution_hz = LED_RMT_RESOLUTION;
+    channelConfig.mem_block_symbols = 64;
+    channelConfig.trans_queue_depth = 2;
+    #if SOC_RMT_SUPPORT_DMA
+      channelConfig.flags.with_dma = true;
+      channelConfig.mem_block_symbols = 1024;
+    #endif
+    if (rmt_new_tx_channel(&channelConfig, &ledChannel) != ESP_OK) {
+      Serial.println("LED output: RMT channel unavailable, using show()");
+      ledChannel = nullptr;
+      return false;
+    }
+
+    // WS2812 bit timings: 0 = 0.3 us high / 0.9 us low, 1 = 0.9 us high / 0.3 us low
+    rmt_bytes_encoder_config_t bytesConfig = {};
+    bytesConfig.bit0.level0 = 1;
+    bytesConfig.bit0.duration0 = 3;
+    bytesConfig.bit0.level1 = 0;
+    bytesConfig.bit0.duration1 = 9;
+    bytesConfig.bit1.level0 = 1;
+    bytesConfig.bit1.duration0 = 9;
+    bytesConfig.bit1.level1 = 0;
+    bytesConfig.bit1.duration1 = 3;
+    bytesConfig.flags.msb_first = 1;
+    rmt_new_bytes_encoder(&bytesConfig, &ledEncoder.bytesEncoder);
+
+    rmt_copy_encoder_config_t copyConfig = {};
+    rmt_new_copy_encoder(&copyConfig, &ledEncoder.copyEncoder);
+
+    uint16_t resetTicks = LED_RMT_RESOLUTION / 1000000 * LED_RESET_US / 2;
+    ledEncoder.resetCode.level0 = 0;
+    ledEncoder.resetCode.duration0 = resetTicks;
+    ledEncoder.resetCode.level1 = 0;
+    ledEncoder.resetCode.duration1 = resetTicks;
+    ledEncoder.base.encode = encodeLedStrip;
+    ledEncoder.base.reset = resetLedStripEncoder;
+    ledEncoder.base.del = deleteLedStripEncoder;
+    ledEncoder.state = RMT_ENCODING_RESET;
+
+    rmt_tx_event_callbacks_t callbacks = {};
+    callbacks.on_trans_done = onLedFrameDone;
+    rmt_tx_register_event_callbacks(ledChannel, &callbacks, nullptr);
+    rmt_enable(ledChannel);
+
+    Serial.println("LED output: asynchronous RMT");
+    return true;
+  #else
+    Serial.println("LED output: blocking show() (needs Arduino-ESP32 3.x for RMT)");
+    return false;
+  #endif
+}
+
+// Function to check whether showFrame() can take a frame now
+bool ledOutputReady() {
+  #if LED_OUTPUT_RMT
+    if (ledChannel != nullptr) {
+      return ledInFlight.load(std::memory_order_acquire) < 2;
+    }
+  #endif
+  return true;
+}
+
+// Function to send the strip buffer to the LEDs without waiting for the transfer.
+// Returns false if the frame was dropped because both buffers were busy.
+bool showFrame() {
+  #if LED_OUTPUT_RMT
+    if (ledChannel != nullptr) {
+      uint8_t inFlight = ledInFlight.load(std::memory_order_acquire);
+      if (inFlight >= 2) {
+        ledFramesDropped++;
+        return false;
+      }
+      if (inFlight == 1) {
+        ledFramesLate++;
+      }
+
+      // Buffers complete in order, so the next one is never the one on the wire
+      uint8_t* buffer = ledBuffers[ledNextBuffer];
+      preparePixels(strip.getPixels(), buffer, FRAME_BYTES);
+      ledNextBuffer ^= 1;
+
+      rmt_transmit_config_t transmitConfig = {};
+      ledInFlight.fetch_add(1, std::memory_order_acq_rel);
+      if (rmt_transmit(ledChannel, &ledEncoder.base, buffer, FRAME_BYTES, &transmitConfig) != ESP_OK) {
+        ledInFlight.fetch_sub(1, std::memory_order_acq_rel);
+        ledFramesDropped++;
+        return false;
+      }
+      ledFramesShown++;
+      return true;
+    }
+  #endif
+
+  // Blocking fallback: send the corrected frame, then restore the strip buffer
+  static uint8_t original[FRAME_BYTES];
+  uint8_t* pixels = strip.getPixels();
+  memcpy(original, pixels, FRAME_BYTES);
+  preparePixels(original, pixels, FRAME_BYTES);
+  strip.show();
+  memcpy(pixels, original, FRAME_BYTES);
+  ledFramesShown++;
+  return true;
+}
+
+#endif // LED_OUTPUT_H
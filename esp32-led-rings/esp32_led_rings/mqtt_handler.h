@@ -4,6 +4,9 @@
 #include <PubSubClient.h>
 #include "wifi_setup.h"
 #include "pin_definitions.h"
+#include "ring_frame.h"
+#include "ring_animation.h"
+#include "frame_stream.h"
 
 #ifdef ESP32
   #include <esp_system.h>  // For esp_read_efuse_mac
@@ -28,113 +31,250 @@ String getClientId() {
 // MQTT Topics - using dynamic client ID
 String topic_publish = "/cca/led/rings/pub";    // Topic to publish messages
 String topic_subscribe = "/cca/led/rings"; // Topic to subscribe to
+String topic_frame = "/cca/led/rings/frame";   // Binary RGB frame for all pixels
+String topic_levels = "/cca/led/rings/levels"; // Binary per-ring level vector
+String topic_effect = "/cca/led/rings/effect"; // Animation selection
+String topic_stream = "/cca/led/rings/stream"; // Binary frame stream (see frame_stream.h)
+
+const int64_t MAX_START_AHEAD_MS = 600000;    // Latest accepted effect start, 10 minutes ahead
 
 // Create WiFi and MQTT clients
 WiFiClient espClient;
 PubSubClient client(espClient);
 
-// Forward declaration of the NeoPixel object
-extern Adafruit_NeoPixel strip;
-extern const int RING_COUNT;
-extern const int ring_counts[];
-
-// Function to set ring LEDs
+// Function to set ring LEDs (single ring, one show())
 void setRingBrightness(int ring, int percentage) {
-  Serial.println("\n=== Setting Ring LEDs ===");
-  Serial.print("Ring: ");
-  Serial.println(ring);
-  Serial.print("Percentage: ");
-  Serial.println(percentage);
-  
-  // Calculate the starting index for this ring
-  int start_index = 0;
-  for(int i = 0; i < ring; i++) {
-    start_index += ring_counts[i];
-  }
-  Serial.print("Starting LED index: ");
-  Serial.println(start_index);
-  
-  // Calculate how many LEDs to light up based on percentage
-  int leds_to_light = (ring_counts[ring] * percentage) / 100;
-  Serial.print("LEDs to light: ");
-  Serial.print(leds_to_light);
-  Serial.print(" out of ");
-  Serial.println(ring_counts[ring]);
-  
-  // Turn off all LEDs in the ring first
-  Serial.println("Turning off all LEDs in ring...");
-  for(int i = 0; i < ring_counts[ring]; i++) {
-    strip.setPixelColor(start_index + i, strip.Color(0, 0, 0));
-  }
-  
-  // Light up the calculated number of LEDs
-  Serial.println("Lighting up LEDs...");
-  for(int i = 0; i < leds_to_light; i++) {
-    strip.setPixelColor(start_index + i, strip.Color(255, 255, 255));
-  }
-  
-  strip.show();
-  Serial.println("LED update complete");
-  Serial.println("=====================\n");
+  stageRingLevel(ring, percentage);
+  commitRings();
+}
+
+// Function to parse one "RING<number>:<percentage>" command, returns false if invalid
+bool parseRingCommand(const char* command, long& ring, long& percentage) {
+  if (strncmp(command, "RING", 4) != 0) {
+    return false;
+  }
+  char* end;
+  ring = strtol(command + 4, &end, 10);
+  if (end == command + 4 || *end != ':') {
+    return false;
+  }
+  const char* percentageStr = end + 1;
+  percentage = strtol(percentageStr, &end, 10);
+  if (end == percentageStr || (*end != '\0' && *end != ',')) {
+    return false;
+  }
+  return ring >= 0 && ring < RING_COUNT && percentage >= 0 && percentage <= 100;
+}
+
+// Function to apply a comma-separated list of ring commands in one show().
+// The whole list is validated first, so an invalid entry leaves the strip unchanged.
+// Returns the number of rings updated, or -1 with invalidCommand set.
+int applyRingCommands(const char* message, const char*& invalidCommand) {
+  long ring;
+  long percentage;
+  int count = 0;
+  for (const char* command = message; command != nullptr; count++) {
+    if (!parseRingCommand(command, ring, percentage)) {
+      invalidCommand = command;
+      return -1;
+    }
+    command = strchr(command, ',');
+    if (command != nullptr) {
+      command++;
+    }
+  }
+
+  for (const char* command = message; command != nullptr; ) {
+    parseRingCommand(command, ring, percentage);
+    stageRingLevel(ring, percentage);
+    command = strchr(command, ',');
+    if (command != nullptr) {
+      command++;
+    }
+  }
+  commitRings();
+  return count;
+}
+
+// Function to parse one numeric effect parameter in [min, max], advancing text to the
+// character after it; that character must be the end or one of terminators
+bool parseEffectField(const char*& text, long min, long max, long& value, const char* terminators) {
+  char* end;
+  value = strtol(text, &end, 10);
+  if (end == text || value < min || value > max) {
+    return false;
+  }
+  if (*end != '\0' && strchr(terminators, *end) == nullptr) {
+    return false;
+  }
+  text = end;
+  return true;
+}
+
+// Function to handle an effect command, returns false if invalid
+// Format: <effect>[:<r>,<g>,<b>[,<periodMs>]][@<startMs>] or "stop",
+// e.g. "breathe:0,0,255,3000" or "chase:255,0,0@1767225600000"
+// startMs is Unix time in milliseconds; sent to several devices it makes them start
+// together. Without network time the effect starts at once.
+bool handleEffectCommand(const char* command) {
+  if (strcmp(command, "stop") == 0) {
+    stopAnimation();
+    return true;
+  }
+
+  int64_t startMs = -1;
+  const char* at = strchr(command, '@');
+  if (at != nullptr) {
+    char* end;
+    long long requested = strtoll(at + 1, &end, 10);
+    if (end == at + 1 || *end != '\0' || requested < 0) {
+      return false;
+    }
+    if (isTimeSynced()) {
+      // Refuse starts too far ahead, most likely a mistyped time
+      if (requested - syncedTimeMs() > MAX_START_AHEAD_MS) {
+        return false;
+      }
+      startMs = requested;
+    } else {
+      Serial.println("Effect start time ignored, clock not synced");
+    }
+  }
+
+  char name[16];
+  const char* params = strchr(command, ':');
+  if (params != nullptr && at != nullptr && params > at) {
+    return false;
+  }
+  size_t nameLength = strcspn(command, ":@");
+  if (nameLength >= sizeof(name)) {
+    return false;
+  }
+  memcpy(name, command, nameLength);
+  name[nameLength] = '\0';
+
+  AnimationEffect effect = getEffectByName(name);
+  if (effect == ANIM_NONE) {
+    return false;
+  }
+
+  // Missing parameters keep their current values
+  int red = animationRed;
+  int green = animationGreen;
+  int blue = animationBlue;
+  long period = animationPeriod;
+  if (params != nullptr) {
+    const char* field = params + 1;
+    long value[3];
+    for (int i = 0; i < 3; i++) {
+      if (!parseEffectField(field, 0, 255, value[i], i < 2 ? "," : ",@")) {
+        return false;
+      }
+      if (i < 2) {
+        if (*field != ',') return false;
+        field++;
+      }
+    }
+    red = value[0];
+    green = value[1];
+    blue = value[2];
+    if (*field == ',') {
+      field++;
+      if (!parseEffectField(field, 1, 65535, period, "@")) {
+        return false;
+      }
+    }
+    // The parameters must end the command or be followed by the start time
+    if (*field != '\0' && *field != '@') {
+      return false;
+    }
+  }
+
+  startAnimation(effect, red, green, blue, period, startMs);
+  return true;
 }
 
 // Callback function for received MQTT messages
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  Serial.println("\n=== MQTT Message Received ===");
-  Serial.print("Topic: ");
-  Serial.println(topic);
-  Serial.print("Payload length: ");
-  Serial.println(length);
-  
-  // Convert payload to string
-  String message = "";
-  for (int i = 0; i < length; i++) {
-    message += (char)payload[i];
-  }
-  Serial.print("Message: ");
-  Serial.println(message);
-
-  // Handle ring-specific messages
-  if (message.startsWith("RING")) {
-    Serial.println("Processing RING command...");
-    // Format: RING<number>:<percentage>
-    int colonIndex = message.indexOf(':');
-    if (colonIndex != -1) {
-      String ringStr = message.substring(4, colonIndex);
-      String percentageStr = message.substring(colonIndex + 1);
-      
-      int ring = ringStr.toInt();
-      int percentage = percentageStr.toInt();
-      
-      Serial.print("Parsed ring: ");
-      Serial.println(ring);
-      Serial.print("Parsed percentage: ");
-      Serial.println(percentage);
-      
-      // Validate ring number and percentage
-      if (ring >= 0 && ring < RING_COUNT && percentage >= 0 && percentage <= 100) {
-        Serial.println("Parameters valid, setting ring...");
-        setRingBrightness(ring, percentage);
-        
-        // Publish confirmation
-        String response = "RING" + String(ring) + " set to " + String(percentage) + "% (" + 
-                         String((ring_counts[ring] * percentage) / 100) + " LEDs)";
-        Serial.print("Sending response: ");
-        Serial.println(response);
-        publishMessage(response.c_str());
-      } else {
-        String error = "Invalid parameters: RING" + String(ring) + ":" + String(percentage);
-        Serial.print("Error: ");
-        Serial.println(error);
-        publishMessage(error.c_str());
-      }
+  // Binary frame topics are applied directly, without text conversion or logging
+  if (topic_frame == topic) {
+    stopAnimation();
+    if (!applyFrame(payload, length)) {
+      publishMessage("Invalid frame length");
+    }
+    return;
+  }
+  if (topic_stream == topic) {
+    applyStreamPacket(payload, length);
+    return;
+  }
+  if (topic_levels == topic) {
+    stopAnimation();
+    if (!applyRingLevels(payload, length)) {
+      publishMessage("Invalid level vector");
+    }
+    return;
+  }
+
+  // Copy the payload into a terminated buffer
+  char message[128];
+  if (length >= sizeof(message)) {
+    publishMessage("Message too long");
+    return;
+  }
+  memcpy(message, payload, length);
+  message[length] = '\0';
+
+  if (topic_effect == topic) {
+    if (!handleEffectCommand(message)) {
+      publishMessage("Invalid effect");
+    }
+    return;
+  }
+
+  // Handle ring commands
+  // Format: RING<number>:<percentage>[,RING<number>:<percentage>...]
+  // All rings in one message are validated, then sent to the strip with a single show()
+  if (strncmp(message, "RING", 4) == 0) {
+    stopAnimation();
+    const char* invalidCommand = nullptr;
+    int updated = applyRingCommands(message, invalidCommand);
+
+    if (updated >= 0) {
+      String response = "Updated " + String(updated) + (updated == 1 ? " ring" : " rings");
+      publishMessage(response.c_str());
     } else {
-      Serial.println("Invalid message format - missing colon");
+      String error = "Invalid parameters: " + String(invalidCommand) + " (no rings updated)";
+      publishMessage(error.c_str());
     }
+  } else if (strcmp(message, "STATS") == 0) {
+    // Format: frames=<shown> late=<late> dropped=<dropped> animLate=<late animation frames>
+    //         stream=<received>/<applied> stale=<n> noBase=<n> invalid=<n>
+    //         mA=<estimated current of the last frame> limited=<frames scaled to the budget>
+    char stats[224];
+    snprintf(stats, sizeof(stats),
+             "frames=%lu late=%lu dropped=%lu animLate=%lu stream=%lu/%lu stale=%lu noBase=%lu invalid=%lu mA=%lu limited=%lu",
+             (unsigned long)ledFramesShown, (unsigned long)ledFramesLate,
+             (unsigned long)ledFramesDropped, (unsigned long)animationLateFrames,
+             (unsigned long)streamStats.received, (unsigned long)streamStats.applied,
+             (unsigned long)streamStats.stale, (unsigned long)streamStats.noBase,
+             (unsigned long)streamStats.invalid, (unsigned long)ledLastCurrentMa,
+             (unsigned long)ledLimitedFrames);
+    publishMessage(stats);
+  } else if (strcmp(message, "TIME") == 0) {
+    // Format: synced=<0|1> now=<Unix ms> error=<us> rtt=<us> drift=<ppb> samples=<n> rejected=<n> steps=<n>
+    char status[160];
+    snprintf(status, sizeof(status),
+             "synced=%d now=%lld error=%ld rtt=%ld drift=%ld samples=%lu rejected=%lu steps=%lu",
+             isTimeSynced() ? 1 : 0, (long long)syncedTimeMs(),
+             (long)timeSyncStats.lastErrorUs, (long)timeSyncStats.lastRttUs, (long)syncDriftPpb,
+             (unsigned long)timeSyncStats.samples, (unsigned long)timeSyncStats.rejected,
+             (unsigned long)timeSyncStats.steps);
+    publishMessage(status);
   } else {
-    Serial.println("Unknown message format");
+    Serial.print("Unknown message format: ");
+    Serial.println(message);
   }
-  Serial.println("==========================\n");
 }
 
 // Function to reconnect to MQTT broker
@@ -166,6 +306,10 @@ void reconnectMQTT() {
       Serial.print("Subscribing to topic: ");
       Serial.println(topic_subscribe);
       client.subscribe(topic_subscribe.c_str());
+      client.subscribe(topic_frame.c_str());
+      client.subscribe(topic_levels.c_str());
+      client.subscribe(topic_effect.c_str());
+      client.subscribe(topic_stream.c_str());
       Serial.println("Subscription complete");
     } else {
       Serial.print("MQTT connection failed, rc=");
@@ -197,6 +341,8 @@ void setupMQTT() {
   Serial.println("\n=== MQTT Setup ===");
   client.setServer(mqtt_server, mqtt_port);
   client.setCallback(mqttCallback);
+  // Default 256-byte buffer is too small for a full frame or stream keyframe
+  client.setBufferSize(STREAM_MAX_PACKET + 64);
   Serial.println("MQTT setup complete");
   Serial.println("=================\n");
 }
@@ -211,19 +357,11 @@ void mqttLoop() {
 
 // Function to publish a message
 void publishMessage(const char* message) {
-  Serial.println("\n=== Publishing MQTT Message ===");
-  Serial.print("Topic: ");
-  Serial.println(topic_publish);
-  Serial.print("Message: ");
-  Serial.println(message);
-  
   if (client.connected()) {
     client.publish(topic_publish.c_str(), message);
-    Serial.println("Message published successfully");
   } else {
     Serial.println("Failed to publish - MQTT not connected");
   }
-  Serial.println("=============================\n");
 }
 
-#endif // MQTT_HANDLER_H 
\ No newline at end of file
+#endif // MQTT_HANDLER_H
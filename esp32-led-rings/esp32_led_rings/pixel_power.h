@@ -0,0 +1,48 @@
+#ifndef PIXEL_POWER_H
+#define PIXEL_POWER_H
+
+#include <Adafruit_NeoPixel.h>
+
+// Output stage applied to every frame on its way to the LEDs.
+// Each channel goes through the gamma table (Adafruit_NeoPixel::gamma8), then the
+// frame's supply current is estimated and, if it is over budget, every channel is
+// scaled down by the same factor so the strip never draws more than the supply can
+// deliver. Integer only: two passes over the frame with one table lookup per byte.
+const bool LED_GAMMA_ENABLED = true;
+const uint32_t LED_POWER_BUDGET_MA = 4000;     // Supply current available for the LEDs
+const uint32_t LED_CHANNEL_MA = 20;            // Current of one channel at full brightness
+const uint32_t LED_IDLE_MA = 1;                // Quiescent current per pixel
+
+// Power statistics
+uint32_t ledLastCurrentMa = 0;    // Estimated current of the last frame, after limiting
+uint32_t ledLimitedFrames = 0;    // Frames scaled down to fit the budget
+
+// Function to gamma-correct and power-limit bytes pixel bytes from in to out,
+// returns the estimated current in mA of the frame as sent
+uint32_t preparePixels(const uint8_t* in, uint8_t* out, size_t bytes) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    uint8_t value = LED_GAMMA_ENABLED ? Adafruit_NeoPixel::gamma8(in[i]) : in[i];
+    out[i] = value;
+    sum += value;
+  }
+
+  uint32_t idleMa = (bytes / 3) * LED_IDLE_MA;
+  uint32_t channelMa = (sum * LED_CHANNEL_MA) / 255;
+  uint32_t availableMa = LED_POWER_BUDGET_MA > idleMa ? LED_POWER_BUDGET_MA - idleMa : 0;
+
+  if (channelMa > availableMa) {
+    // Scale factor in 1/256 steps, rounded down so the result stays under budget
+    uint32_t scale = (availableMa << 8) / channelMa;
+    for (size_t i = 0; i < bytes; i++) {
+      out[i] = (out[i] * scale) >> 8;
+    }
+    channelMa = (channelMa * scale) >> 8;
+    ledLimitedFrames++;
+  }
+
+  ledLastCurrentMa = idleMa + channelMa;
+  return ledLastCurrentMa;
+}
+
+#endif // PIXEL_POWER_H
@@ -0,0 +1,191 @@
+#ifndef RING_ANIMATION_H
+#define RING_ANIMATION_H
+
+#include <Adafruit_NeoPixel.h>
+#include "ring_layout.h"
+#include "ring_frame.h"
+#include "time_sync.h"
+
+// Non-blocking animation engine.
+// animationLoop() is called from loop() and renders at most one frame per call, on a
+// fixed 60 fps schedule; between frames it returns immediately so MQTT and HTTP keep
+// being serviced. All animation math is fixed point: time is a 16-bit phase
+// (0-65535 = one period) and brightness is 0-255.
+// The phase is taken from the network clock (time_sync.h), so devices given the same
+// start time render the same frame at the same moment, even if the command reached
+// them at different times.
+
+// Available effects
+enum AnimationEffect {
+  ANIM_NONE = 0,
+  ANIM_CHASE,     // A head with a fading tail runs around every ring
+  ANIM_BREATHE,   // All rings fade in and out together
+  ANIM_FILL,      // Every ring fills up and empties again
+  ANIM_RIPPLE     // A wave travels from the centre ring outwards
+};
+
+const uint32_t ANIMATION_FRAME_US = 1000000 / 60;  // 60 fps
+const uint8_t CHASE_TAIL = 6;                      // Pixels in the chase tail
+const uint8_t RIPPLE_WIDTH = 3;                    // Rings lit by the ripple wave
+
+// Animation state
+AnimationEffect animationEffect = ANIM_NONE;
+uint8_t animationRed = 255;
+uint8_t animationGreen = 255;
+uint8_t animationBlue = 255;
+uint16_t animationPeriod = 2000;    // Milliseconds per cycle
+int64_t animationStartMs = 0;       // Start time on the syncedTimeMs() clock
+uint32_t nextFrameTime = 0;
+uint32_t animationFrames = 0;
+uint32_t animationLateFrames = 0;
+
+// Function to get an effect by name, ANIM_NONE if unknown
+AnimationEffect getEffectByName(const char* name) {
+  if (strcmp(name, "chase") == 0) return ANIM_CHASE;
+  if (strcmp(name, "breathe") == 0) return ANIM_BREATHE;
+  if (strcmp(name, "fill") == 0) return ANIM_FILL;
+  if (strcmp(name, "ripple") == 0) return ANIM_RIPPLE;
+  return ANIM_NONE;
+}
+
+// Smoothstep easing, 3x^2 - 2x^3, with x and the result in 0-65535
+uint16_t easeInOut(uint16_t x) {
+  uint32_t x2 = ((uint32_t)x * x) >> 16;
+  uint32_t y = (x2 * ((3 * 65536 - 2 * (uint32_t)x) >> 2)) >> 14;
+  return y > 65535 ? 65535 : y;
+}
+
+// Triangle wave, 0 -> 65535 -> 0 over one phase
+uint16_t triangleWave(uint16_t phase) {
+  return phase < 32768 ? phase * 2 : (65535 - phase) * 2;
+}
+
+// Function to get the animation colour scaled to a brightness (0-255)
+uint32_t scaledColor(uint8_t level) {
+  uint16_t scale = level + 1;
+  return Adafruit_NeoPixel::Color((animationRed * scale) >> 8,
+                                  (animationGreen * scale) >> 8,
+                                  (animationBlue * scale) >> 8);
+}
+
+void renderChase(uint16_t phase) {
+  for (int ring = 0; ring < RING_COUNT; ring++) {
+    uint16_t start = ring_offsets[ring];
+    uint16_t count = ring_counts[ring];
+    uint16_t head = ((uint32_t)phase * count) >> 16;
+    uint8_t tail = count < CHASE_TAIL ? count : CHASE_TAIL;
+
+    strip.fill(0, start, count);
+    for (uint8_t t = 0; t < tail; t++) {
+      uint16_t pixel = (head + count - t) % count;
+      strip.setPixelColor(start + pixel, scaledColor(255 - (t * 255) / tail));
+    }
+  }
+}
+
+void renderBreathe(uint16_t phase) {
+  uint8_t level = easeInOut(triangleWave(phase)) >> 8;
+  strip.fill(scaledColor(level), 0, TOTAL_PIXELS);
+}
+
+void renderFill(uint16_t phase) {
+  uint16_t amount = easeInOut(triangleWave(phase));
+  uint32_t color = scaledColor(255);
+  for (int ring = 0; ring < RING_COUNT; ring++) {
+    uint16_t start = ring_offsets[ring];
+    uint16_t count = ring_counts[ring];
+    uint16_t lit = ((uint32_t)amount * count + 32767) >> 16;
+
+    if (lit > 0) {
+      strip.fill(color, start, lit);
+    }
+    if (lit < count) {
+      strip.fill(0, start + lit, count - lit);
+    }
+  }
+}
+
+void renderRipple(uint16_t phase) {
+  // Wave front position in 1/256 ring steps, from the centre ring (last) outwards,
+  // travelling far enough for the wave to leave the outer ring
+  uint32_t span = (RING_COUNT + RIPPLE_WIDTH) << 8;
+  uint32_t front = ((uint32_t)phase * span) >> 16;
+
+  for (int ring = 0; ring < RING_COUNT; ring++) {
+    uint32_t fromCentre = (RING_COUNT - 1 - ring) << 8;
+    uint8_t level = 0;
+    if (front >= fromCentre) {
+      uint32_t behind = front - fromCentre;
+      if (behind < (RIPPLE_WIDTH << 8)) {
+        // Bright at the front, easing out towards the back of the wave
+        uint16_t x = 65535 - (behind << 16) / (RIPPLE_WIDTH << 8);
+        level = easeInOut(x) >> 8;
+      }
+    }
+    strip.fill(scaledColor(level), ring_offsets[ring], ring_counts[ring]);
+  }
+}
+
+// Function to start an effect; color and period apply until the next start.
+// startMs is a syncedTimeMs() time to start at, or -1 for now. A start in the past
+// joins the effect at the phase it has reached.
+void startAnimation(AnimationEffect effect, uint8_t red, uint8_t green, uint8_t blue, uint16_t periodMs,
+                    int64_t startMs = -1) {
+  int64_t now = syncedTimeMs();
+  animationEffect = effect;
+  animationRed = red;
+  animationGreen = green;
+  animationBlue = blue;
+  animationPeriod = periodMs > 0 ? periodMs : 1;
+  animationStartMs = startMs >= 0 ? startMs : now;
+
+  // Put the frame ticks on the start time, so synchronised devices also share them
+  int64_t wait = animationStartMs - now;
+  nextFrameTime = micros() + (wait > 0 ? (uint32_t)(wait * 1000) : 0);
+}
+
+// Function to stop the running effect, the strip keeps its last frame
+void stopAnimation() {
+  animationEffect = ANIM_NONE;
+}
+
+bool isAnimating() {
+  return animationEffect != ANIM_NONE;
+}
+
+// Function to render the next frame when it is due, call from loop()
+void animationLoop() {
+  if (animationEffect == ANIM_NONE) return;
+
+  uint32_t now = micros();
+  if ((int32_t)(now - nextFrameTime) < 0) return;
+
+  // Keep a fixed schedule; if a frame is more than one interval late, skip ahead
+  // instead of rendering a burst of catch-up frames
+  nextFrameTime += ANIMATION_FRAME_US;
+  if ((int32_t)(now - nextFrameTime) >= 0) {
+    nextFrameTime = now + ANIMATION_FRAME_US;
+    animationLateFrames++;
+  }
+
+  // Scheduled start not reached yet, the strip keeps its current frame
+  int64_t elapsedMs = syncedTimeMs() - animationStartMs;
+  if (elapsedMs < 0) return;
+
+  uint32_t elapsed = elapsedMs % animationPeriod;
+  uint16_t phase = ((uint32_t)elapsed << 16) / animationPeriod;
+
+  switch (animationEffect) {
+    case ANIM_CHASE: renderChase(phase); break;
+    case ANIM_BREATHE: renderBreathe(phase); break;
+    case ANIM_FILL: renderFill(phase); break;
+    case ANIM_RIPPLE: renderRipple(phase); break;
+    default: return;
+  }
+
+  ringsPending = true;
+  commitRings();
+  animationFrames++;
+}
+
+#endif // RING_ANIMATION_H
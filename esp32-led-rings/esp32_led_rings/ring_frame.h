@@ -0,0 +1,75 @@
+#ifndef RING_FRAME_H
+#define RING_FRAME_H
+
+#include <Adafruit_NeoPixel.h>
+#include "ring_layout.h"
+#include "led_output.h"
+
+// Forward declaration of the NeoPixel object
+extern Adafruit_NeoPixel strip;
+
+// Set when staged pixels have not been sent to the strip yet
+bool ringsPending = false;
+
+// Function to stage a ring fill level (0-100 percent) without updating the strip
+void stageRingLevel(int ring, uint8_t percentage, uint32_t color = Adafruit_NeoPixel::Color(255, 255, 255)) {
+  uint16_t start = ring_offsets[ring];
+  uint16_t count = ring_counts[ring];
+  uint16_t lit = (count * percentage) / 100;
+
+  if (lit > 0) {
+    strip.fill(color, start, lit);
+  }
+  if (lit < count) {
+    strip.fill(0, start + lit, count - lit);
+  }
+  ringsPending = true;
+}
+
+// Function to send all staged ring updates to the strip in one show().
+// While both output buffers are busy the update stays pending; loop() calls this
+// again, so the last update of a burst is never lost.
+void commitRings() {
+  if (!ringsPending || !ledOutputReady()) return;
+  if (showFrame()) {
+    ringsPending = false;
+  }
+}
+
+// Function to apply a full frame in one show()
+// Format: 3 bytes (R, G, B) per pixel, in strip order, FRAME_BYTES total
+bool applyFrame(const uint8_t* data, size_t length) {
+  if (length != FRAME_BYTES) {
+    return false;
+  }
+
+  for (int i = 0; i < TOTAL_PIXELS; i++) {
+    const uint8_t* rgb = data + i * 3;
+    strip.setPixelColor(i, rgb[0], rgb[1], rgb[2]);
+  }
+
+  ringsPending = true;
+  commitRings();
+  return true;
+}
+
+// Function to apply a fill level to every ring in one show()
+// Format: 1 byte per ring (0-100 percent), RING_COUNT bytes total
+bool applyRingLevels(const uint8_t* levels, size_t length) {
+  if (length != (size_t)RING_COUNT) {
+    return false;
+  }
+  for (int ring = 0; ring < RING_COUNT; ring++) {
+    if (levels[ring] > 100) {
+      return false;
+    }
+  }
+
+  for (int ring = 0; ring < RING_COUNT; ring++) {
+    stageRingLevel(ring, levels[ring]);
+  }
+  commitRings();
+  return true;
+}
+
+#endif // RING_FRAME_H
@@ -0,0 +1,28 @@
+#ifndef RING_LAYOUT_H
+#define RING_LAYOUT_H
+
+#include <Arduino.h>
+
+// Ring geometry, outermost ring first. Everything here is constexpr, so ring
+// start indexes are table lookups instead of a prefix sum on every update.
+constexpr int RING_COUNT = 9;
+constexpr uint8_t ring_counts[RING_COUNT] = {60, 48, 40, 32, 24, 16, 12, 8, 1};
+
+// Function to get the first pixel of a ring (ring == RING_COUNT gives the total)
+constexpr uint16_t ringStart(int ring) {
+  return ring <= 0 ? 0 : ringStart(ring - 1) + ring_counts[ring - 1];
+}
+
+// Start index of each ring, plus the total pixel count as the last entry
+constexpr uint16_t ring_offsets[RING_COUNT + 1] = {
+  ringStart(0), ringStart(1), ringStart(2), ringStart(3), ringStart(4),
+  ringStart(5), ringStart(6), ringStart(7), ringStart(8), ringStart(9)
+};
+
+// Total number of LEDs across all rings and the size of a raw RGB frame
+constexpr int TOTAL_PIXELS = ring_offsets[RING_COUNT];
+constexpr size_t FRAME_BYTES = TOTAL_PIXELS * 3;
+
+static_assert(TOTAL_PIXELS == 241, "Ring layout does not match the 241-pixel strip");
+
+#endif // RING_LAYOUT_H
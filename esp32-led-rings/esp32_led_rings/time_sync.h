@@ -0,0 +1,175 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <esp_timer.h>
+
+// Network time for effects that start together on several devices.
+// A small SNTP client polls a local NTP server (by default the MQTT broker host) over
+// UDP. Each reply gives the clock offset, corrected for the network round trip; the
+// offset is tracked together with the local crystal's drift, so syncedTimeMs() stays
+// accurate between polls. Replies with a long round trip are discarded because their
+// offset is unreliable. The local timebase is esp_timer (microseconds since boot), which
+// never wraps.
+
+const char* ntp_server = "192.168.100.1";  // Local NTP server, e.g. chrony on the broker
+const uint16_t NTP_PORT = 123;
+const uint16_t TIME_SYNC_LOCAL_PORT = 12300;
+const uint32_t TIME_SYNC_FAST_MS = 4000;       // Poll interval until the drift has settled
+const uint32_t TIME_SYNC_SLOW_MS = 64000;      // Poll interval afterwards
+const uint8_t TIME_SYNC_FAST_SAMPLES = 8;
+const int64_t TIME_SYNC_MAX_RTT_US = 20000;    // Longer round trips are discarded
+const int64_t TIME_SYNC_STEP_US = 50000;       // Larger errors step the clock instead of slewing
+const int32_t TIME_SYNC_MAX_DRIFT_PPB = 500000;
+const uint32_t NTP_UNIX_OFFSET = 2208988800UL; // Seconds from 1900 to 1970
+
+// Sync statistics
+struct TimeSyncStats {
+  uint32_t samples;     // Replies used
+  uint32_t rejected;    // Replies dropped (invalid or round trip too long)
+  uint32_t steps;       // Times the clock was stepped
+  int32_t lastErrorUs;  // Offset error of the last reply against the prediction
+  int32_t lastRttUs;    // Round trip of the last reply
+};
+
+TimeSyncStats timeSyncStats = {0, 0, 0, 0, 0};
+
+WiFiUDP ntpUdp;
+bool timeSynced = false;
+int64_t syncBaseLocalUs = 0;    // Local time of the last correction
+int64_t syncBaseOffsetUs = 0;   // Offset (network - local) at syncBaseLocalUs
+int32_t syncDriftPpb = 0;       // Offset change per second of local time, in ns
+int64_t ntpRequestLocalUs = 0;  // Local time the outstanding request was sent
+unsigned long lastNtpRequest = 0;
+bool ntpRequestSent = false;
+
+int64_t localClockUs() {
+  return esp_timer_get_time();
+}
+
+// Predicted offset (network - local) at a local time
+int64_t offsetAtUs(int64_t localUs) {
+  return syncBaseOffsetUs + (localUs - syncBaseLocalUs) * syncDriftPpb / 1000000000LL;
+}
+
+// Function to get network time in microseconds since 1970 (time since boot until synced)
+int64_t syncedTimeUs() {
+  int64_t local = localClockUs();
+  return timeSynced ? local + offsetAtUs(local) : local;
+}
+
+// Function to get network time in milliseconds since 1970 (time since boot until synced)
+int64_t syncedTimeMs() {
+  return syncedTimeUs() / 1000;
+}
+
+bool isTimeSynced() {
+  return timeSynced;
+}
+
+// NTP timestamp (32.32 fixed point seconds since 1900) at data to Unix microseconds
+int64_t readNtpTimestampUs(const uint8_t* data) {
+  uint32_t seconds = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+  uint32_t fraction = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | data[7];
+  // NTP era 1 starts in 2036
+  int64_t unixSeconds = seconds >= NTP_UNIX_OFFSET ? (int64_t)(seconds - NTP_UNIX_OFFSET)
+                                                   : (int64_t)seconds + 4294967296LL - NTP_UNIX_OFFSET;
+  return unixSeconds * 1000000LL + (((uint64_t)fraction * 1000000ULL) >> 32);
+}
+
+// Function to fold one offset measurement into the offset and drift estimate
+void applyTimeSample(int64_t localUs, int64_t measuredOffsetUs) {
+  if (!timeSynced) {
+    syncBaseOffsetUs = measuredOffsetUs;
+    syncBaseLocalUs = localUs;
+    syncDriftPpb = 0;
+    timeSynced = true;
+    Serial.println("Time sync: clock set from NTP");
+    return;
+  }
+
+  int64_t predicted = offsetAtUs(localUs);
+  int64_t error = measuredOffsetUs - predicted;
+  timeSyncStats.lastErrorUs = error;
+
+  if (error > TIME_SYNC_STEP_US || error < -TIME_SYNC_STEP_US) {
+    syncBaseOffsetUs = measuredOffsetUs;
+    syncBaseLocalUs = localUs;
+    timeSyncStats.steps++;
+    return;
+  }
+
+  // Slew: take half the error now and a quarter of the implied rate into the drift
+  int64_t interval = localUs - syncBaseLocalUs;
+  if (interval > 0) {
+    int64_t drift = syncDriftPpb + error * 1000000000LL / interval / 4;
+    if (drift > TIME_SYNC_MAX_DRIFT_PPB) drift = TIME_SYNC_MAX_DRIFT_PPB;
+    if (drift < -TIME_SYNC_MAX_DRIFT_PPB) drift = -TIME_SYNC_MAX_DRIFT_PPB;
+    syncDriftPpb = drift;
+  }
+  syncBaseOffsetUs = predicted + error / 2;
+  syncBaseLocalUs = localUs;
+}
+
+// Function to check a reply to the outstanding request and use it
+void handleNtpReply(const uint8_t* packet, int length, int64_t receivedLocalUs) {
+  // Server mode (4), a synchronised stratum, and the echo of our request timestamp
+  if (length < 48 || (packet[0] & 0x07) != 4 || packet[1] == 0 || !ntpRequestSent ||
+      memcmp(packet + 24, &ntpRequestLocalUs, sizeof(ntpRequestLocalUs)) != 0) {
+    timeSyncStats.rejected++;
+    return;
+  }
+  ntpRequestSent = false;
+
+  int64_t t1 = ntpRequestLocalUs;
+  int64_t t2 = readNtpTimestampUs(packet + 32);  // Server receive
+  int64_t t3 = readNtpTimestampUs(packet + 40);  // Server transmit
+  int64_t t4 = receivedLocalUs;
+
+  int64_t rtt = (t4 - t1) - (t3 - t2);
+  timeSyncStats.lastRttUs = rtt;
+  if (rtt < 0 || rtt > TIME_SYNC_MAX_RTT_US) {
+    timeSyncStats.rejected++;
+    return;
+  }
+
+  applyTimeSample(t4, ((t2 - t1) + (t3 - t4)) / 2);
+  timeSyncStats.samples++;
+}
+
+// Function to start listening for NTP replies
+void setupTimeSync() {
+  ntpUdp.begin(TIME_SYNC_LOCAL_PORT);
+  Serial.print("Time sync: NTP server ");
+  Serial.println(ntp_server);
+}
+
+// Function to poll the NTP server when due and process replies, call from loop()
+void timeSyncLoop() {
+  uint8_t packet[48];
+  while (ntpUdp.parsePacket() > 0) {
+    int64_t receivedLocalUs = localClockUs();
+    int length = ntpUdp.read(packet, sizeof(packet));
+    handleNtpReply(packet, length, receivedLocalUs);
+  }
+
+  if (WiFi.status() != WL_CONNECTED) return;
+
+  uint32_t interval = timeSyncStats.samples < TIME_SYNC_FAST_SAMPLES ? TIME_SYNC_FAST_MS : TIME_SYNC_SLOW_MS;
+  if (lastNtpRequest != 0 && millis() - lastNtpRequest < interval) return;
+  lastNtpRequest = millis();
+
+  // Client request (LI 0, version 4, mode 3); our local time goes in the transmit
+  // timestamp field so the server echoes it back as the originate timestamp
+  memset(packet, 0, sizeof(packet));
+  packet[0] = 0x23;
+  ntpRequestLocalUs = localClockUs();
+  memcpy(packet + 40, &ntpRequestLocalUs, sizeof(ntpRequestLocalUs));
+  ntpRequestSent = true;
+  ntpUdp.beginPacket(ntp_server, NTP_PORT);
+  ntpUdp.write(packet, sizeof(packet));
+  ntpUdp.endPacket();
+}
+
+#endif // TIME_SYNC_H
@@ -0,0 +1,91 @@
+#ifndef WEB_SERVER_H
+#define WEB_SERVER_H
+
+#include <WebServer.h>
+#include "ring_frame.h"
+#include "ring_animation.h"
+
+// Create web server instance
+WebServer server(80);
+
+// Staging buffer for raw POST bodies (large enough for a full frame)
+uint8_t uploadBuffer[FRAME_BYTES];
+size_t uploadLength = 0;
+bool uploadOverflow = false;
+bool uploadStarted = false;  // Set by RAW_START; empty or form bodies never get here
+
+// Function to collect a raw (non-form) POST body into the staging buffer
+void handleRawUpload() {
+  HTTPRaw& raw = server.raw();
+
+  if (raw.status == RAW_START) {
+    uploadLength = 0;
+    uploadOverflow = false;
+    uploadStarted = true;
+  } else if (raw.status == RAW_WRITE) {
+    if (uploadLength + raw.currentSize > sizeof(uploadBuffer)) {
+      uploadOverflow = true;
+      return;
+    }
+    memcpy(uploadBuffer + uploadLength, raw.buf, raw.currentSize);
+    uploadLength += raw.currentSize;
+  }
+}
+
+// Function to check that this request delivered a raw body that fit the buffer
+bool hasValidUpload() {
+  return uploadStarted && !uploadOverflow;
+}
+
+// Function to clear the staging buffer state after a handler used it, so a later
+// request without a raw body cannot re-apply it
+void resetUpload() {
+  uploadLength = 0;
+  uploadOverflow = false;
+  uploadStarted = false;
+}
+
+// Function to handle POST /frame (FRAME_BYTES of RGB data)
+void handleFramePost() {
+  stopAnimation();
+  bool applied = hasValidUpload() && applyFrame(uploadBuffer, uploadLength);
+  resetUpload();
+  if (applied) {
+    server.send(200, "text/plain", "OK");
+  } else {
+    server.send(400, "text/plain", "Expected " + String(FRAME_BYTES) + " bytes of RGB data");
+  }
+}
+
+// Function to handle POST /levels (one 0-100 byte per ring)
+void handleLevelsPost() {
+  stopAnimation();
+  bool applied = hasValidUpload() && applyRingLevels(uploadBuffer, uploadLength);
+  resetUpload();
+  if (applied) {
+    server.send(200, "text/plain", "OK");
+  } else {
+    server.send(400, "text/plain", "Expected " + String(RING_COUNT) + " level bytes (0-100)");
+  }
+}
+
+// Function to setup web server
+void setupWebServer() {
+  Serial.println("\n=== Web Server Setup ===");
+
+  // Set up web server routes
+  server.on("/frame", HTTP_POST, handleFramePost, handleRawUpload);
+  server.on("/levels", HTTP_POST, handleLevelsPost, handleRawUpload);
+
+  // Start web server
+  server.begin();
+  Serial.println("HTTP server started");
+  Serial.println("=======================\n");
+}
+
+// Function to handle web server
+void handleWebServer() {
+  server.handleClient();
+}
+
+#endif // WEB_SERVER_H
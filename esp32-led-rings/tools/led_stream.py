@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Encoder for the esp32-led-rings binary frame stream.
+
+Frames are bytes of R, G, B per pixel in strip order (241 pixels for the ring
+board). FrameStreamEncoder turns each frame into a packet: an RLE keyframe at
+the start and every `keyframe_interval` frames, otherwise an RLE XOR delta
+against the previous frame (or a keyframe when that is smaller). Packets can be
+sent over UDP (port 7777) or MQTT (/cca/led/rings/stream); the packet format is
+documented in esp32_led_rings/frame_stream.h.
+
+Run directly to stream a test pattern:
+    python3 led_stream.py --host 192.168.100.50 --fps 30
+    python3 led_stream.py --mqtt 192.168.100.1 --fps 30   (needs paho-mqtt)
+"""
+
+import argparse
+import colorsys
+import socket
+import struct
+import time
+
+MAGIC = 0xA5
+KEYFRAME_RAW = 0
+KEYFRAME_RLE = 1
+DELTA_RLE = 2
+
+TOTAL_PIXELS = 241
+RING_COUNTS = [60, 48, 40, 32, 24, 16, 12, 8, 1]
+UDP_PORT = 7777
+MQTT_TOPIC = "/cca/led/rings/stream"
+
+
+def encode_rle(pixels):
+    """RLE-encode RGB pixel bytes: runs of 2+ identical pixels become one repeat."""
+    count = len(pixels) // 3
+    out = bytearray()
+    literals = bytearray()
+    literal_count = 0
+    i = 0
+
+    def flush_literals():
+        nonlocal literals, literal_count
+        if literal_count:
+            out.append(literal_count - 1)
+            out.extend(literals)
+            literals = bytearray()
+            literal_count = 0
+
+    while i < count:
+        pixel = pixels[i * 3:i * 3 + 3]
+        run = 1
+        while i + run < count and run < 128 and pixels[(i + run) * 3:(i + run) * 3 + 3] == pixel:
+            run += 1
+
+        if run >= 2:
+            flush_literals()
+            out.append(0x7F + run)
+            out.extend(pixel)
+        else:
+            literals.extend(pixel)
+            literal_count += 1
+            if literal_count == 128:
+                flush_literals()
+        i += run
+
+    flush_literals()
+    return bytes(out)
+
+
+class FrameStreamEncoder:
+    """Turns successive frames into stream packets, tracking sequence numbers."""
+
+    def __init__(self, pixel_count=TOTAL_PIXELS, keyframe_interval=30):
+        self.pixel_count = pixel_count
+        self.keyframe_interval = keyframe_interval
+        self.sequence = 0
+        self.previous = None
+        self.since_keyframe = 0
+
+    def _packet(self, frame_type, base, payload):
+        header = struct.pack("<BBHHH", MAGIC, frame_type, self.sequence, base, self.pixel_count)
+        return header + payload
+
+    def encode(self, frame):
+        frame = bytes(frame)
+        if len(frame) != self.pixel_count * 3:
+            raise ValueError("frame must be %d bytes" % (self.pixel_count * 3))
+
+        keyframe = encode_rle(frame)
+        frame_type, payload, base = KEYFRAME_RLE, keyframe, 0
+        if len(keyframe) >= len(frame):
+            frame_type, payload = KEYFRAME_RAW, frame
+
+        if self.previous is not None and self.since_keyframe < self.keyframe_interval:
+            xor = bytes(a ^ b for a, b in zip(frame, self.previous))
+            delta = encode_rle(xor)
+            if len(delta) < len(payload):
+                frame_type, payload = DELTA_RLE, delta
+                base = (self.sequence - 1) & 0xFFFF
+
+        packet = self._packet(frame_type, base, payload)
+        self.since_keyframe = self.since_keyframe + 1 if frame_type == DELTA_RLE else 1
+        self.previous = frame
+        self.sequence = (self.sequence + 1) & 0xFFFF
+        return packet
+
+    def force_keyframe(self):
+        """Make the next packet a keyframe with sequence 0, e.g. after a receiver restart.
+
+        Sequence 0 makes the receiver resynchronise whatever sequence it was at; if that
+        packet is lost, the next periodic keyframe resynchronises it as well.
+        """
+        self.previous = None
+        self.sequence = 0
+
+
+class UdpSender:
+    def __init__(self, host, port=UDP_PORT):
+        self.address = (host, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    def send(self, packet):
+        self.sock.sendto(packet, self.address)
+
+
+class MqttSender:
+    def __init__(self, broker, port=1883, topic=MQTT_TOPIC):
+        import paho.mqtt.client as mqtt
+        self.topic = topic
+        self.client = mqtt.Client()
+        self.client.connect(broker, port)
+        self.client.loop_start()
+
+    def send(self, packet):
+        # QoS 0: a late frame is worthless, the sequence number drops stale ones anyway
+        self.client.publish(self.topic, packet, qos=0)
+
+
+def rainbow_frame(t):
+    """Test pattern: each ring rotates a rainbow at its own speed."""
+    frame = bytearray()
+    for ring, count in enumerate(RING_COUNTS):
+        for i in range(count):
+            hue = (i / count + t * (0.1 + ring * 0.05)) % 1.0
+            r, g, b = colorsys.hsv_to_rgb(hue, 1.0, 0.5)
+            frame.extend((int(r * 255), int(g * 255), int(b * 255)))
+    return bytes(frame)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--host", help="ring controller IP for UDP streaming")
+    parser.add_argument("--mqtt", help="MQTT broker IP instead of UDP")
+    parser.add_argument("--fps", type=float, default=30.0)
+    parser.add_argument("--keyframe-interval", type=int, default=30)
+    args = parser.parse_args()
+
+    if args.mqtt:
+        sender = MqttSender(args.mqtt)
+    elif args.host:
+        sender = UdpSender(args.host)
+    else:
+        parser.error("give --host or --mqtt")
+
+    encoder = FrameStreamEncoder(keyframe_interval=args.keyframe_interval)
+    interval = 1.0 / args.fps
+    start = time.monotonic()
+    next_frame = start
+    sent_bytes = 0
+    frames = 0
+
+    while True:
+        packet = encoder.encode(rainbow_frame(time.monotonic() - start))
+        sender.send(packet)
+        sent_bytes += len(packet)
+        frames += 1
+        if frames % int(args.fps * 5) == 0:
+            print("%d frames, average %.0f bytes/frame" % (frames, sent_bytes / frames))
+
+        next_frame += interval
+        time.sleep(max(0.0, next_frame - time.monotonic()))
+
+
+if __name__ == "__main__":
+    main()
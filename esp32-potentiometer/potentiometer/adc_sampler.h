@@ -0,0 +1,154 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Background ADC sampling.
+// The ADC runs in continuous (DMA) mode and averages ADC_OVERSAMPLE conversions per
+// pin in hardware. Each averaged frame is passed through a median filter (removes
+// single-frame spikes) and a fixed-point IIR low-pass by a dedicated task, which then
+// publishes the result to an atomic. loop() reads the latest value without blocking.
+// Continuous mode only supports ADC1 pins (GPIO32-39 on the ESP32).
+const uint8_t ADC_MAX_CHANNELS = 4;
+const uint32_t ADC_SAMPLE_RATE_HZ = 20000;            // Total conversions per second
+const uint32_t ADC_OVERSAMPLE = 64;                   // Conversions averaged per frame and pin
+const uint8_t ADC_MEDIAN_WINDOW = 5;                  // Frames in the median filter, odd
+const uint8_t ADC_IIR_SHIFT = 3;                      // IIR weight of a new frame = 1/8
+const uint32_t ADC_TASK_STACK = 3072;
+const UBaseType_t ADC_TASK_PRIORITY = 5;              // Above loop() so frames are never late
+
+// Filter state for one pin. Only the sampler task writes it; loop() reads value only.
+struct AdcChannel {
+  uint8_t pin;
+  uint16_t medianHistory[ADC_MEDIAN_WINDOW];
+  uint8_t medianIndex;
+  uint8_t medianFilled;
+  int32_t iirState;                 // Filtered value << ADC_IIR_SHIFT
+  std::atomic<uint16_t> value;      // Latest filtered value, 0-4095
+};
+
+AdcChannel adcChannels[ADC_MAX_CHANNELS];
+uint8_t adcChannelCount = 0;
+TaskHandle_t adcTaskHandle = nullptr;
+std::atomic<uint32_t> adcFrameCount(0);
+
+// Conversion-done interrupt, wakes the sampler task
+void ARDUINO_ISR_ATTR onAdcFrameReady() {
+  BaseType_t woken = pdFALSE;
+  if (adcTaskHandle != nullptr) {
+    vTaskNotifyGiveFromISR(adcTaskHandle, &woken);
+  }
+  portYIELD_FROM_ISR(woken);
+}
+
+// Function to get the median of the last frames of a channel
+uint16_t adcMedian(const AdcChannel& channel) {
+  uint16_t sorted[ADC_MEDIAN_WINDOW];
+  uint8_t count = channel.medianFilled;
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t v = channel.medianHistory[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+  return sorted[count / 2];
+}
+
+// Function to run one averaged frame through the filters of a channel
+void filterAdcFrame(AdcChannel& channel, uint16_t raw) {
+  channel.medianHistory[channel.medianIndex] = raw;
+  channel.medianIndex = (channel.medianIndex + 1) % ADC_MEDIAN_WINDOW;
+  if (channel.medianFilled < ADC_MEDIAN_WINDOW) {
+    channel.medianFilled++;
+  }
+  int32_t median = adcMedian(channel);
+
+  if (channel.medianFilled == 1) {
+    channel.iirState = median << ADC_IIR_SHIFT;
+  } else {
+    channel.iirState += median - (channel.iirState >> ADC_IIR_SHIFT);
+  }
+
+  // Only move the output once the filter is more than one count away from it,
+  // so the published value does not toggle between two neighbouring counts
+  int32_t current = (int32_t)channel.value.load(std::memory_order_relaxed) << ADC_IIR_SHIFT;
+  if (abs(channel.iirState - current) > (1 << ADC_IIR_SHIFT)) {
+    int32_t rounded = (channel.iirState + (1 << (ADC_IIR_SHIFT - 1))) >> ADC_IIR_SHIFT;
+    channel.value.store((uint16_t)rounded, std::memory_order_release);
+  }
+}
+
+// Sampler task - drains completed DMA frames and filters them
+void adcSamplerTask(void* arg) {
+  adc_continuous_data_t* frame = nullptr;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // One notification can stand for several frames if the task was delayed
+    while (analogContinuousRead(&frame, 0)) {
+      for (uint8_t i = 0; i < adcChannelCount; i++) {
+        for (uint8_t c = 0; c < adcChannelCount; c++) {
+          if (frame[c].pin == adcChannels[i].pin) {
+            filterAdcFrame(adcChannels[i], frame[c].avg_read_raw);
+            break;
+          }
+        }
+      }
+      adcFrameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+// Function to start background sampling of the given pins
+bool setupAdcSampler(const uint8_t pins[], uint8_t count) {
+  if (count == 0 || count > ADC_MAX_CHANNELS) {
+    Serial.println("ADC sampler: invalid channel count");
+    return false;
+  }
+
+  adcChannelCount = count;
+  for (uint8_t i = 0; i < count; i++) {
+    adcChannels[i].pin = pins[i];
+    adcChannels[i].medianIndex = 0;
+    adcChannels[i].medianFilled = 0;
+    adcChannels[i].iirState = 0;
+    adcChannels[i].value.store(0);
+  }
+
+  xTaskCreatePinnedToCore(adcSamplerTask, "adc", ADC_TASK_STACK, nullptr,
+                          ADC_TASK_PRIORITY, &adcTaskHandle, 0);
+
+  analogContinuousSetWidth(12);
+  analogContinuousSetAtten(ADC_11db);
+  if (!analogContinuous(pins, count, ADC_OVERSAMPLE, ADC_SAMPLE_RATE_HZ, &onAdcFrameReady) ||
+      !analogContinuousStart()) {
+    Serial.println("ADC sampler: failed to start continuous mode");
+    return false;
+  }
+
+  Serial.print("ADC sampler: ");
+  Serial.print(ADC_SAMPLE_RATE_HZ / (ADC_OVERSAMPLE * count));
+  Serial.println(" frames/s per pin");
+  return true;
+}
+
+// Function to get the latest filtered value of a pin, or -1 if it is not sampled
+int getAdcValue(uint8_t pin) {
+  for (uint8_t i = 0; i < adcChannelCount; i++) {
+    if (adcChannels[i].pin == pin) {
+      return adcChannels[i].value.load(std::memory_order_acquire);
+    }
+  }
+  return -1;
+}
+
+// Function to get the number of frames processed since startup
+uint32_t getAdcFrameCount() {
+  return adcFrameCount.load(std::memory_order_relaxed);
+}
+
+#endif // ADC_SAMPLER_H
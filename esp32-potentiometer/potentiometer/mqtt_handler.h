@@ -8,6 +8,7 @@
 const char* mqtt_server = "192.168.1.100";
 const int mqtt_port = 1883;
 const char* mqtt_topic = "/cca/potentiometer/blue";
+const char* mqtt_encoder_topic = "/cca/potentiometer/blue/encoder";
 
 WiFiClient espClient;
 PubSubClient client(espClient);
@@ -46,4 +47,16 @@ void publishPotentiometerValue(int value) {
   client.publish(mqtt_topic, msg);
 }
 
+void publishEncoderDelta(int32_t delta, int64_t position, float velocity, float acceleration) {
+  if (!client.connected()) {
+    reconnectMQTT();
+  }
+  client.loop();
+  
+  char msg[128];
+  snprintf(msg, sizeof(msg), "{\"delta\":%ld,\"position\":%lld,\"velocity\":%.1f,\"acceleration\":%.1f}",
+           (long)delta, (long long)position, velocity, acceleration);
+  client.publish(mqtt_encoder_topic, msg);
+}
+
 #endif 
\ No newline at end of file
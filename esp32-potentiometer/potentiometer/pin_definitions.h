@@ -1,12 +1,16 @@
 #ifndef PIN_DEFINITIONS_H
 #define PIN_DEFINITIONS_H
 
-// Potentiometer Pin
-#define POT_PIN 15 // D15
+// Potentiometer Pin (must be an ADC1 pin for continuous sampling, ADC2 is shared with WiFi)
+#define POT_PIN 34 // D34
 
 // LED Pin for ESP32 WROOM 32
 #define LED_PIN 5
 
+// Rotary Encoder Pins
+#define ENCODER_PIN_A 2  // D2
+#define ENCODER_PIN_B 16 // D16
+
 // Board detection and pin definitions
 #ifdef ESP32
   // ESP32-WROOM-32 pin configuration
@@ -2,29 +2,19 @@
 #include "pin_definitions.h"
 #include "wifi_setup.h"
 #include "mqtt_handler.h"
-
-// Rotary Encoder Pins
-#define ENCODER_PIN_A 2  // D2
-#define ENCODER_PIN_B 16 // D16
-
-// Potentiometer Pin
-#define POT_PIN 15 // D15
-
-// LED Pin for ESP32 WROOM 32 (using GPIO 5 instead of 2 to avoid conflict with encoder)
-#define LED_PIN 5
+#include "rotary_encoder.h"
+#include "adc_sampler.h"
 
 // Variables for rotary encoder
-volatile int encoderCount = 0;
-volatile int lastEncoded = 0;
-volatile long encoderValue = 0;
+int64_t lastPublishedPosition = 0;
+unsigned long lastEncoderPublish = 0;
+const unsigned long ENCODER_PUBLISH_INTERVAL = 50; // Publish accumulated deltas at most every 50ms
 
 // Variables for potentiometer
 int potValue = 0;
-int lastPotValue = 0;
-
-// Variables for debouncing
-unsigned long lastDebounceTime = 0;
-unsigned long debounceDelay = 5; // milliseconds
+int lastPotValue = -1;
+unsigned long lastPotPublish = 0;
+const unsigned long POT_PUBLISH_INTERVAL = 20; // Publish changes at most every 20ms
 
 // Debug mode - set to true to enable detailed serial output
 #define DEBUG_MODE true
@@ -49,29 +39,6 @@ void debugPrintValue(const char* label, int value) {
   }
 }
 
-void updateEncoder() {
-  // Read the current state of the encoder pins
-  int MSB = digitalRead(ENCODER_PIN_A);
-  int LSB = digitalRead(ENCODER_PIN_B);
-
-  // Combine the two bits to form a binary number
-  int encoded = (MSB << 1) | LSB;
-  
-  // Calculate the difference between the current and last state
-  int sum = (lastEncoded << 2) | encoded;
-
-  // Handle the state change
-  if (sum == 0b1101 || sum == 0b0100 || sum == 0b0010 || sum == 0b1011) {
-    encoderValue++;
-  }
-  if (sum == 0b1110 || sum == 0b0111 || sum == 0b0001 || sum == 0b1000) {
-    encoderValue--;
-  }
-
-  // Update the last encoded value
-  lastEncoded = encoded;
-}
-
 void setup() {
   // Initialize Serial communication
   Serial.begin(9600);
@@ -84,9 +51,14 @@ void setup() {
   digitalWrite(LED_PIN, HIGH); // Turn on LED to indicate startup
   debugPrint("LED pin initialized");
   
-  // Set up potentiometer pin
-  pinMode(POT_PIN, INPUT);
-  debugPrint("Potentiometer pin initialized");
+  // Start background sampling of the potentiometer
+  const uint8_t adcPins[] = {POT_PIN};
+  setupAdcSampler(adcPins, 1);
+  debugPrint("Potentiometer sampling started");
+  
+  // Set up rotary encoder
+  setupEncoder();
+  debugPrint("Rotary encoder initialized");
   
   // Setup WiFi
   debugPrint("Setting up WiFi...");
@@ -103,12 +75,13 @@ void setup() {
 }
 
 void loop() {
-  // Read potentiometer value
-  potValue = analogRead(POT_PIN);
+  // Latest filtered potentiometer value, the sampler task keeps it up to date
+  potValue = getAdcValue(POT_PIN);
   
-  // Print and publish potentiometer value when it changes significantly
-  if (abs(potValue - lastPotValue) > 10) { // Only process if change is more than 10
+  // Print and publish potentiometer value when it changes
+  if (potValue != lastPotValue && millis() - lastPotPublish >= POT_PUBLISH_INTERVAL) {
     lastPotValue = potValue;
+    lastPotPublish = millis();
     
     // Print to Serial for debugging
     debugPrintValue("Potentiometer Value", potValue);
@@ -119,15 +92,29 @@ void loop() {
     debugPrint("MQTT publish complete");
   }
   
+  // Publish encoder movement as a delta since the last publish
+  if (millis() - lastEncoderPublish >= ENCODER_PUBLISH_INTERVAL) {
+    lastEncoderPublish = millis();
+    EncoderState encoder = getEncoderState();
+    
+    if (encoder.position != lastPublishedPosition) {
+      int32_t delta = (int32_t)(encoder.position - lastPublishedPosition);
+      lastPublishedPosition = encoder.position;
+      publishEncoderDelta(delta, encoder.position, encoder.velocity, encoder.acceleration);
+    }
+  }
+  
   // Periodic debug output
   if (DEBUG_MODE && millis() - lastDebugTime >= DEBUG_INTERVAL) {
     lastDebugTime = millis();
     debugPrintValue("Current Potentiometer Reading", potValue);
+    debugPrintValue("ADC Frames", (int)getAdcFrameCount());
+    debugPrintValue("Encoder Position", (int)getEncoderState().position);
     debugPrintValue("WiFi Status", WiFi.status());
     debugPrintValue("MQTT Connection Status", client.connected() ? 1 : 0);
     debugPrintValue("RSSI", WiFi.RSSI());
   }
   
-  // Small delay to prevent overwhelming the output
-  delay(10);
+  // Yield briefly, readings and publishes are paced above
+  delay(1);
 } 
\ No newline at end of file
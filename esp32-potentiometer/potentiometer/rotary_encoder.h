@@ -0,0 +1,158 @@
+#ifndef ROTARY_ENCODER_H
+#define ROTARY_ENCODER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <driver/pulse_cnt.h>
+#include "pin_definitions.h"
+
+// Rotary encoder decoding.
+// By default the ESP32 pulse counter (PCNT) decodes the quadrature signal in hardware
+// (x4, with its glitch filter), so no CPU time is spent per edge. Uses the IDF 5
+// pulse_cnt driver (Arduino-ESP32 3.x, as adc_sampler.h already needs). Set
+// ENCODER_USE_PCNT to false to fall back to a table-driven pin-change interrupt.
+// In both modes a 100 Hz esp_timer extends the raw count to a 64-bit position and
+// estimates velocity and acceleration, independent of how long loop() stalls.
+const bool ENCODER_USE_PCNT = true;
+const bool ENCODER_REVERSE = false;                   // Flip the counting direction
+const int ENCODER_PCNT_LIMIT = 30000;                 // Hardware counter range, extended by the driver
+const uint32_t ENCODER_GLITCH_NS = 12000;             // Ignore pulses shorter than 12us
+const uint32_t ENCODER_SAMPLE_PERIOD_US = 10000;      // Position/velocity sample period
+const float ENCODER_VELOCITY_ALPHA = 0.25;            // IIR smoothing for velocity and acceleration
+
+// Encoder state shared between the sample timer and loop()
+struct EncoderState {
+  int64_t position;      // Counts since startup
+  float velocity;        // Counts per second
+  float acceleration;    // Counts per second squared
+};
+
+EncoderState encoderState = {0, 0.0, 0.0};
+portMUX_TYPE encoderMux = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t encoderTimer = nullptr;
+int32_t encoderLastRaw = 0;
+pcnt_unit_handle_t encoderUnit = nullptr;
+
+// Software fallback state, written by the pin-change interrupt
+volatile int32_t encoderSoftwareCount = 0;
+volatile uint8_t encoderLastState = 0;
+
+// Quadrature transition table indexed by (previous AB << 2) | current AB.
+// Invalid transitions (both bits changed, i.e. a glitch or a missed edge) count 0.
+const int8_t ENCODER_TRANSITIONS[16] = {
+   0, -1,  1,  0,
+   1,  0,  0, -1,
+  -1,  0,  0,  1,
+   0,  1, -1,  0
+};
+
+// Pin-change interrupt for the software fallback
+void IRAM_ATTR handleEncoderInterrupt() {
+  uint8_t state = (digitalRead(ENCODER_PIN_A) << 1) | digitalRead(ENCODER_PIN_B);
+  encoderSoftwareCount += ENCODER_TRANSITIONS[(encoderLastState << 2) | state];
+  encoderLastState = state;
+}
+
+// Function to read the raw (wrapping) encoder count
+int32_t readEncoderRaw() {
+  if (ENCODER_USE_PCNT) {
+    int count = 0;
+    pcnt_unit_get_count(encoderUnit, &count);
+    return count;
+  }
+  return encoderSoftwareCount;
+}
+
+// Sample timer callback - accumulates position and estimates velocity/acceleration
+void sampleEncoder(void* arg) {
+  int32_t raw = readEncoderRaw();
+  int32_t delta = raw - encoderLastRaw;
+  encoderLastRaw = raw;
+
+  if (ENCODER_REVERSE) {
+    delta = -delta;
+  }
+
+  const float dt = ENCODER_SAMPLE_PERIOD_US / 1000000.0;
+  float instantVelocity = delta / dt;
+
+  portENTER_CRITICAL(&encoderMux);
+  float lastVelocity = encoderState.velocity;
+  encoderState.position += delta;
+  encoderState.velocity += (instantVelocity - lastVelocity) * ENCODER_VELOCITY_ALPHA;
+  encoderState.acceleration += ((encoderState.velocity - lastVelocity) / dt - encoderState.acceleration) * ENCODER_VELOCITY_ALPHA;
+  portEXIT_CRITICAL(&encoderMux);
+}
+
+// Function to configure the PCNT unit for x4 quadrature decoding
+void setupEncoderPcnt() {
+  // accum_count keeps counting across the limit watch points, so the count never wraps
+  pcnt_unit_config_t unitConfig = {};
+  unitConfig.high_limit = ENCODER_PCNT_LIMIT;
+  unitConfig.low_limit = -ENCODER_PCNT_LIMIT;
+  unitConfig.flags.accum_count = 1;
+  pcnt_new_unit(&unitConfig, &encoderUnit);
+
+  // Hardware glitch filter
+  pcnt_glitch_filter_config_t filterConfig = {};
+  filterConfig.max_glitch_ns = ENCODER_GLITCH_NS;
+  pcnt_unit_set_glitch_filter(encoderUnit, &filterConfig);
+
+  // Channel A: count edges on A, direction from B
+  pcnt_chan_config_t channelConfig = {};
+  channelConfig.edge_gpio_num = ENCODER_PIN_A;
+  channelConfig.level_gpio_num = ENCODER_PIN_B;
+  pcnt_channel_handle_t channelA = nullptr;
+  pcnt_new_channel(encoderUnit, &channelConfig, &channelA);
+  pcnt_channel_set_edge_action(channelA, PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+  pcnt_channel_set_level_action(channelA, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+
+  // Channel B: count edges on B, direction from A
+  channelConfig.edge_gpio_num = ENCODER_PIN_B;
+  channelConfig.level_gpio_num = ENCODER_PIN_A;
+  pcnt_channel_handle_t channelB = nullptr;
+  pcnt_new_channel(encoderUnit, &channelConfig, &channelB);
+  pcnt_channel_set_edge_action(channelB, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+  pcnt_channel_set_level_action(channelB, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+
+  // Watch points at the limits let the driver accumulate overflows
+  pcnt_unit_add_watch_point(encoderUnit, ENCODER_PCNT_LIMIT);
+  pcnt_unit_add_watch_point(encoderUnit, -ENCODER_PCNT_LIMIT);
+
+  pcnt_unit_enable(encoderUnit);
+  pcnt_unit_clear_count(encoderUnit);
+  pcnt_unit_start(encoderUnit);
+}
+
+// Function to setup the rotary encoder
+void setupEncoder() {
+  pinMode(ENCODER_PIN_A, INPUT_PULLUP);
+  pinMode(ENCODER_PIN_B, INPUT_PULLUP);
+
+  if (ENCODER_USE_PCNT) {
+    setupEncoderPcnt();
+    Serial.println("Rotary encoder: using PCNT hardware decoder");
+  } else {
+    encoderLastState = (digitalRead(ENCODER_PIN_A) << 1) | digitalRead(ENCODER_PIN_B);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_PIN_A), handleEncoderInterrupt, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(ENCODER_PIN_B), handleEncoderInterrupt, CHANGE);
+    Serial.println("Rotary encoder: using software decoder");
+  }
+  encoderLastRaw = readEncoderRaw();
+
+  esp_timer_create_args_t timerArgs = {};
+  timerArgs.callback = sampleEncoder;
+  timerArgs.name = "encoder";
+  esp_timer_create(&timerArgs, &encoderTimer);
+  esp_timer_start_periodic(encoderTimer, ENCODER_SAMPLE_PERIOD_US);
+}
+
+// Function to get a consistent copy of the encoder state
+EncoderState getEncoderState() {
+  portENTER_CRITICAL(&encoderMux);
+  EncoderState state = encoderState;
+  portEXIT_CRITICAL(&encoderMux);
+  return state;
+}
+
+#endif // ROTARY_ENCODER_H
@@ -0,0 +1,195 @@
+#ifndef BATTERY_ESTIMATOR_H
+#define BATTERY_ESTIMATOR_H
+
+#include <Arduino.h>
+
+// Battery state-of-charge estimator.
+// Voltage is read through the factory ADC calibration (eFuse, via analogReadMilliVolts)
+// on the ESP32 family; the ESP8266 has none, so its full-scale value is a constant to
+// calibrate once against a multimeter. Each reading averages a burst of samples with
+// the extremes dropped, adds back the drop across the cell's internal resistance at
+// the current load, smooths the result and looks the charge up in a per-chemistry
+// discharge curve. Time to empty comes from the observed discharge rate, or from the
+// capacity and load current until enough discharge has been seen.
+
+// Discharge curve of one cell: open-circuit mV at 100%, 90%, ... 0%
+struct BatteryChemistry {
+    const char* name;
+    uint16_t cellMillivolts[11];
+    uint16_t internalResistanceMilliohm;   // Per cell
+};
+
+const BatteryChemistry CHEMISTRY_LIPO = {
+    "LiPo", {4200, 4060, 3980, 3920, 3870, 3820, 3790, 3770, 3740, 3680, 3300}, 150
+};
+const BatteryChemistry CHEMISTRY_ALKALINE = {
+    "Alkaline", {1580, 1440, 1380, 1330, 1290, 1250, 1210, 1170, 1130, 1080, 1000}, 250
+};
+const BatteryChemistry CHEMISTRY_NIMH = {
+    "NiMH", {1400, 1300, 1270, 1250, 1240, 1230, 1220, 1200, 1180, 1140, 1000}, 50
+};
+
+const uint8_t BATTERY_SAMPLES = 16;                   // ADC samples per reading
+const uint16_t ESP8266_ADC_FULL_SCALE_MV = 3300;      // Calibrate against a multimeter
+const float BATTERY_FILTER_ALPHA = 0.3;               // Weight of a new reading
+const float BATTERY_RATE_ALPHA = 0.3;                 // Weight of a new discharge rate
+const float BATTERY_RATE_MIN_DROP = 1.0;              // Percent drop needed to measure a rate
+
+class BatteryEstimator {
+private:
+    uint8_t pin;
+    float dividerRatio;
+    uint8_t cells;
+    const BatteryChemistry* chemistry;
+    float capacityMah;
+    float loadCurrentMa;
+
+    bool hasReading;
+    float voltage;               // Filtered terminal voltage under load
+    float openCircuitVoltage;    // Filtered, load compensated
+    float percentage;
+
+    float referencePercentage;   // Start of the current discharge rate measurement
+    unsigned long referenceTime;
+    float dischargeRate;         // Percent per hour, 0 until measured
+
+    // Function to read the pin in mV, averaging a burst with min and max dropped
+    uint32_t readPinMillivolts() {
+        uint32_t sum = 0;
+        uint32_t lowest = UINT32_MAX;
+        uint32_t highest = 0;
+        for (uint8_t i = 0; i < BATTERY_SAMPLES; i++) {
+            #if defined(ESP32)
+                uint32_t sample = analogReadMilliVolts(pin);
+            #else
+                uint32_t sample = (uint32_t)analogRead(pin) * ESP8266_ADC_FULL_SCALE_MV / 1023;
+            #endif
+            sum += sample;
+            if (sample < lowest) lowest = sample;
+            if (sample > highest) highest = sample;
+        }
+        return (sum - lowest - highest) / (BATTERY_SAMPLES - 2);
+    }
+
+    // Function to look up the charge of one cell on the discharge curve
+    float cellPercentage(float cellMv) const {
+        const uint16_t* curve = chemistry->cellMillivolts;
+        if (cellMv >= curve[0]) return 100.0;
+        if (cellMv <= curve[10]) return 0.0;
+
+        uint8_t i = 1;
+        while (cellMv < curve[i]) {
+            i++;
+        }
+        // Interpolate between curve[i - 1] (higher) and curve[i] (lower)
+        float fraction = (cellMv - curve[i]) / (float)(curve[i - 1] - curve[i]);
+        return (10 - i + fraction) * 10.0;
+    }
+
+    void updateDischargeRate(unsigned long now) {
+        float dropped = referencePercentage - percentage;
+        if (dropped < -2.0) {
+            // Charging or a fresh battery, start over
+            referencePercentage = percentage;
+            referenceTime = now;
+            dischargeRate = 0.0;
+        } else if (dropped >= BATTERY_RATE_MIN_DROP) {
+            float hours = (now - referenceTime) / 3600000.0;
+            if (hours > 0.0) {
+                float rate = dropped / hours;
+                dischargeRate = dischargeRate > 0.0
+                    ? dischargeRate + (rate - dischargeRate) * BATTERY_RATE_ALPHA
+                    : rate;
+            }
+            referencePercentage = percentage;
+            referenceTime = now;
+        }
+    }
+
+public:
+    BatteryEstimator() : pin(0), dividerRatio(1.0), cells(1), chemistry(&CHEMISTRY_LIPO),
+                         capacityMah(0.0), loadCurrentMa(0.0), hasReading(false), voltage(0.0),
+                         openCircuitVoltage(0.0), percentage(0.0), referencePercentage(0.0),
+                         referenceTime(0), dischargeRate(0.0) {}
+
+    // dividerRatio = battery voltage / pin voltage
+    void begin(uint8_t adcPin, float ratio, const BatteryChemistry& batteryChemistry,
+               uint8_t cellCount, float batteryCapacityMah) {
+        pin = adcPin;
+        dividerRatio = ratio;
+        chemistry = &batteryChemistry;
+        cells = cellCount;
+        capacityMah = batteryCapacityMah;
+        hasReading = false;
+        dischargeRate = 0.0;
+
+        pinMode(pin, INPUT);
+        #if defined(ESP32)
+            analogReadResolution(12);
+            analogSetAttenuation(ADC_11db);
+        #endif
+    }
+
+    // Typical current drawn while sampling, used to compensate the voltage sag
+    void setLoadCurrent(float milliamps) {
+        loadCurrentMa = milliamps;
+    }
+
+    // Function to take one reading, call every few seconds or less often
+    void update() {
+        unsigned long now = millis();
+        float measured = readPinMillivolts() * dividerRatio / 1000.0;
+        float sag = loadCurrentMa * chemistry->internalResistanceMilliohm * cells / 1000000.0;
+
+        if (!hasReading) {
+            voltage = measured;
+            openCircuitVoltage = measured + sag;
+        } else {
+            voltage += (measured - voltage) * BATTERY_FILTER_ALPHA;
+            openCircuitVoltage += (measured + sag - openCircuitVoltage) * BATTERY_FILTER_ALPHA;
+        }
+        percentage = cellPercentage(openCircuitVoltage * 1000.0 / cells);
+
+        if (!hasReading) {
+            hasReading = true;
+            referencePercentage = percentage;
+            referenceTime = now;
+        } else {
+            updateDischargeRate(now);
+        }
+    }
+
+    bool hasValue() const {
+        return hasReading;
+    }
+
+    float getVoltage() const {
+        return voltage;
+    }
+
+    float getOpenCircuitVoltage() const {
+        return openCircuitVoltage;
+    }
+
+    float getPercentage() const {
+        return percentage;
+    }
+
+    // Estimated minutes until empty, -1 if unknown
+    long getTimeToEmptyMinutes() const {
+        if (!hasReading) return -1;
+        if (dischargeRate > 0.0) {
+            return (long)(percentage / dischargeRate * 60.0);
+        }
+        if (capacityMah > 0.0 && loadCurrentMa > 0.0) {
+            return (long)(percentage / 100.0 * capacityMah / loadCurrentMa * 60.0);
+        }
+        return -1;
+    }
+
+    const char* getChemistryName() const {
+        return chemistry->name;
+    }
+};
+
+#endif // BATTERY_ESTIMATOR_H
@@ -2,65 +2,46 @@
 #define BATTERY_MANAGER_H
 
 #include <Arduino.h>
+#include "BatteryEstimator.h"
 
 class BatteryManager {
 private:
     bool enabled;
     bool initialized;
     const uint8_t BATTERY_PIN = 3;  // Analog input pin for battery voltage
-    const float VOLTAGE_DIVIDER_RATIO = 1.0;  // R1/(R1+R2) - adjusted for actual voltage divider
-    const float MAX_BATTERY_VOLTAGE = 3.2;    // Maximum voltage for 2 fresh AA batteries (1.6V each)
-    const float MIN_BATTERY_VOLTAGE = 2.0;    // Minimum voltage for 2 depleted AA batteries (1.0V each)
-    const float ADC_REFERENCE_VOLTAGE = 3.3;  // ESP32-S2 ADC reference voltage
-    const int ADC_RESOLUTION = 4095;          // ESP32-S2 ADC resolution (12-bit)
+    const float VOLTAGE_DIVIDER_RATIO = 1.0;  // Battery voltage / pin voltage
+    const uint8_t BATTERY_CELLS = 2;          // 2 AA batteries in series
+    const float BATTERY_CAPACITY_MAH = 2500.0; // Typical alkaline AA capacity
+    const float LOAD_CURRENT_MA = 70.0;       // Typical draw with WiFi connected
     
     unsigned long lastUpdate;
-    const unsigned long updateInterval = 1000; // Update every second
+    const unsigned long updateInterval = 5000; // Update every 5 seconds
     
-    float currentVoltage;
-    int currentPercentage;
+    BatteryEstimator estimator;
     
     void updateBatteryLevel() {
-        // Read the analog value
-        int rawValue = analogRead(BATTERY_PIN);
-        
-        // Convert to voltage
-        float voltage = (rawValue * ADC_REFERENCE_VOLTAGE) / ADC_RESOLUTION;
-        
-        // Apply voltage divider ratio
-        voltage *= VOLTAGE_DIVIDER_RATIO;
-        
-        // Calculate percentage
-        int percentage = map(voltage * 100, 
-                           MIN_BATTERY_VOLTAGE * 100, 
-                           MAX_BATTERY_VOLTAGE * 100, 
-                           0, 100);
-        
-        // Constrain percentage between 0 and 100
-        percentage = constrain(percentage, 0, 100);
-        
-        // Update values
-        currentVoltage = voltage;
-        currentPercentage = percentage;
+        estimator.update();
         
         // Print debug information
         // Serial1.print("Battery: ");
-        // Serial1.print(voltage);
+        // Serial1.print(estimator.getVoltage());
         // Serial1.print("V (");
-        // Serial1.print(percentage);
+        // Serial1.print(estimator.getPercentage());
         // Serial1.println("%)");
     }
 
 public:
-    BatteryManager() : enabled(false), initialized(false), 
-                      currentVoltage(0.0), currentPercentage(0) {}
+    BatteryManager() : enabled(false), initialized(false), lastUpdate(0) {}
     
     void begin() {
         if (!enabled || initialized) return;
         
-        // Configure ADC
-        analogReadResolution(12);  // Set ADC resolution to 12 bits
-        analogSetAttenuation(ADC_11db);  // Set attenuation for 0-3.3V range
+        // Configure ADC and take a first reading
+        estimator.begin(BATTERY_PIN, VOLTAGE_DIVIDER_RATIO, CHEMISTRY_ALKALINE,
+                        BATTERY_CELLS, BATTERY_CAPACITY_MAH);
+        estimator.setLoadCurrent(LOAD_CURRENT_MA);
+        updateBatteryLevel();
+        lastUpdate = millis();
         
         initialized = true;
         Serial1.println("BatteryManager: begin: Initialized");
@@ -94,19 +75,24 @@ public:
     }
     
     float getVoltage() {
-        return currentVoltage;
+        return estimator.getVoltage();
     }
     
     int getPercentage() {
-        return currentPercentage;
+        return (int)(estimator.getPercentage() + 0.5);
+    }
+    
+    // Estimated minutes until empty, -1 if unknown
+    long getTimeToEmpty() {
+        return estimator.getTimeToEmptyMinutes();
     }
     
     bool isLow() {
-        return currentPercentage <= 20;  // Consider battery low at 20% or less
+        return getPercentage() <= 20;  // Consider battery low at 20% or less
     }
     
     bool isCritical() {
-        return currentPercentage <= 10;  // Consider battery critical at 10% or less
+        return getPercentage() <= 10;  // Consider battery critical at 10% or less
     }
 };
 
@@ -0,0 +1,164 @@
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <Arduino.h>
+
+// Gestures decoded from a single button
+enum ButtonGestureType {
+    GESTURE_NONE = 0,
+    GESTURE_CLICK,
+    GESTURE_DOUBLE_CLICK,
+    GESTURE_LONG_PRESS,
+    GESTURE_HOLD_REPEAT
+};
+
+// Function to convert a gesture to string
+const char* getGestureName(ButtonGestureType gesture) {
+    switch (gesture) {
+        case GESTURE_CLICK: return "click";
+        case GESTURE_DOUBLE_CLICK: return "double_click";
+        case GESTURE_LONG_PRESS: return "long_press";
+        case GESTURE_HOLD_REPEAT: return "hold_repeat";
+        default: return "none";
+    }
+}
+
+// Non-blocking gesture state machine.
+// Fed with debounced press/release changes and their capture timestamps, plus a
+// periodic update() for the time-outs; it never waits or delays.
+class ButtonGesture {
+public:
+    typedef void (*GestureCallback)(ButtonGestureType gesture);
+
+private:
+    enum State {
+        STATE_IDLE,
+        STATE_PRESSED,        // First press is down
+        STATE_WAIT_SECOND,    // Short press released, waiting for a second press
+        STATE_SECOND_PRESSED, // Second press is down
+        STATE_HOLDING         // Long press reported, repeating while held
+    };
+
+    State state;
+    uint32_t pressTimeUs;
+    uint32_t releaseTimeUs;
+    uint32_t nextRepeatUs;
+
+    uint32_t doubleClickGapUs;   // Max release-to-press gap for a double click, 0 disables
+    uint32_t longPressUs;        // Hold time for a long press
+    uint32_t repeatIntervalUs;   // Hold-repeat interval after a long press, 0 disables
+
+    GestureCallback onGesture;
+
+    void emit(ButtonGestureType gesture) {
+        if (onGesture != nullptr) {
+            onGesture(gesture);
+        }
+    }
+
+public:
+    ButtonGesture() : state(STATE_IDLE), pressTimeUs(0), releaseTimeUs(0), nextRepeatUs(0),
+                      doubleClickGapUs(300000), longPressUs(800000), repeatIntervalUs(200000),
+                      onGesture(nullptr) {}
+
+    // Times in milliseconds
+    void configure(uint32_t doubleClickGapMs, uint32_t longPressMs, uint32_t repeatIntervalMs) {
+        doubleClickGapUs = doubleClickGapMs * 1000;
+        longPressUs = longPressMs * 1000;
+        repeatIntervalUs = repeatIntervalMs * 1000;
+    }
+
+    void setCallback(GestureCallback callback) {
+        onGesture = callback;
+    }
+
+    // Feed one debounced change
+    void handleChange(bool pressed, uint32_t timestampUs) {
+        switch (state) {
+            case STATE_IDLE:
+                if (pressed) {
+                    state = STATE_PRESSED;
+                    pressTimeUs = timestampUs;
+                }
+                break;
+
+            case STATE_PRESSED:
+                if (!pressed) {
+                    if (timestampUs - pressTimeUs >= longPressUs) {
+                        // Held long enough but the time-out was not polled in time
+                        emit(GESTURE_LONG_PRESS);
+                        state = STATE_IDLE;
+                    } else if (doubleClickGapUs == 0) {
+                        emit(GESTURE_CLICK);
+                        state = STATE_IDLE;
+                    } else {
+                        state = STATE_WAIT_SECOND;
+                        releaseTimeUs = timestampUs;
+                    }
+                }
+                break;
+
+            case STATE_WAIT_SECOND:
+                if (pressed) {
+                    if (timestampUs - releaseTimeUs <= doubleClickGapUs) {
+                        state = STATE_SECOND_PRESSED;
+                    } else {
+                        // Time-out was not polled in time, the first press was a click
+                        emit(GESTURE_CLICK);
+                        state = STATE_PRESSED;
+                    }
+                    pressTimeUs = timestampUs;
+                }
+                break;
+
+            case STATE_SECOND_PRESSED:
+                if (!pressed) {
+                    emit(GESTURE_DOUBLE_CLICK);
+                    state = STATE_IDLE;
+                }
+                break;
+
+            case STATE_HOLDING:
+                if (!pressed) {
+                    state = STATE_IDLE;
+                }
+                break;
+        }
+    }
+
+    // Check time-outs, call from loop()
+    void update(uint32_t nowUs) {
+        switch (state) {
+            case STATE_PRESSED:
+                if (nowUs - pressTimeUs >= longPressUs) {
+                    emit(GESTURE_LONG_PRESS);
+                    state = STATE_HOLDING;
+                    nextRepeatUs = pressTimeUs + longPressUs + repeatIntervalUs;
+                }
+                break;
+
+            case STATE_WAIT_SECOND:
+                if (nowUs - releaseTimeUs > doubleClickGapUs) {
+                    emit(GESTURE_CLICK);
+                    state = STATE_IDLE;
+                }
+                break;
+
+            case STATE_HOLDING:
+                if (repeatIntervalUs > 0 && (int32_t)(nowUs - nextRepeatUs) >= 0) {
+                    emit(GESTURE_HOLD_REPEAT);
+                    nextRepeatUs += repeatIntervalUs;
+                    // Skip repeats missed during a long loop stall instead of bursting them
+                    if ((int32_t)(nowUs - nextRepeatUs) >= 0) {
+                        nextRepeatUs = nowUs + repeatIntervalUs;
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+};
+
+#endif // BUTTON_GESTURE_H
@@ -2,6 +2,8 @@
 #define BUTTON_MANAGER_H
 
 #include <Arduino.h>
+#include "ButtonCapture.h"
+#include "ButtonGesture.h"
 
 class ButtonManager {
 private:
@@ -10,48 +12,38 @@ private:
     const uint8_t BUTTON_PIN = 39;  // Button input pin
     const unsigned long DEBOUNCE_DELAY = 50;  // Debounce time in milliseconds
     
-    bool lastButtonState;    // Previous button state
-    bool buttonState;        // Current button state
-    bool lastDebouncedState; // Previous debounced state
+    ButtonCapture capture;   // Interrupt-driven edge capture and debounce
+    ButtonGesture gesture;   // Click / double-click / long-press decoder
     bool debouncedState;     // Current debounced state
-    unsigned long lastDebounceTime;  // Last time the button state changed
+    uint32_t lastChangeMicros;  // Time of the first edge of the last change
     
     // Callback function type for button events
     typedef void (*ButtonCallback)(bool state);
     ButtonCallback onButtonChange;
     
     void updateButtonState() {
-        // Read the current button state (LOW when idle, HIGH when pressed)
-        bool reading = digitalRead(BUTTON_PIN);
+        bool pressed;
+        uint32_t timestampUs;
         
-        // Check if the button state has changed
-        if (reading != lastButtonState) {
-            lastDebounceTime = millis();
-        }
-        
-        // If the button state has been stable for longer than the debounce delay
-        if ((millis() - lastDebounceTime) > DEBOUNCE_DELAY) {
-            // If the debounced state has changed
-            if (reading != debouncedState) {
-                debouncedState = reading;
-                
-                // If the button state has changed and we have a callback
-                if (debouncedState != lastDebouncedState && onButtonChange != nullptr) {
-                    onButtonChange(debouncedState);
-                }
+        // Report every debounced change captured since the last update
+        while (capture.nextChange(pressed, timestampUs)) {
+            debouncedState = pressed;
+            lastChangeMicros = timestampUs;
+            
+            if (onButtonChange != nullptr) {
+                onButtonChange(debouncedState);
             }
+            gesture.handleChange(pressed, timestampUs);
         }
         
-        // Save the current state for next time
-        lastButtonState = reading;
-        lastDebouncedState = debouncedState;
+        // Report time-based gestures (click time-out, long press, hold repeat)
+        gesture.update(micros());
     }
 
 public:
     ButtonManager() : enabled(false), initialized(false),
-                     lastButtonState(false), buttonState(false),
-                     lastDebouncedState(false), debouncedState(false),
-                     lastDebounceTime(0), onButtonChange(nullptr) {}
+                     debouncedState(false), lastChangeMicros(0),
+                     onButtonChange(nullptr) {}
     
     void begin() {
         if (!enabled || initialized) return;
@@ -64,16 +56,16 @@ public:
         // Now switch to input mode with pull-down
         pinMode(BUTTON_PIN, INPUT_PULLDOWN);
         
-        // Read initial state
-        lastButtonState = digitalRead(BUTTON_PIN);
-        debouncedState = lastButtonState;
-        lastDebouncedState = debouncedState;
+        // Start capturing edges (HIGH when pressed)
+        capture.begin(BUTTON_PIN, HIGH, DEBOUNCE_DELAY * 1000);
+        debouncedState = capture.isPressed();
         
         initialized = true;
         Serial1.println("ButtonManager: begin: Initialized");
     }
     
     void setPinLow() {
+        capture.end();
         pinMode(BUTTON_PIN, OUTPUT);
         digitalWrite(BUTTON_PIN, LOW);
         Serial1.println("ButtonManager: Pin set to LOW");
@@ -97,6 +89,7 @@ public:
         if (!enabled) return;
         enabled = false;
         initialized = false;
+        capture.end();
         Serial1.println("ButtonManager: disable: Disabled");
     }
     
@@ -108,11 +101,26 @@ public:
         return debouncedState;
     }
     
+    // micros() time of the first edge of the last change (the real press/release time)
+    uint32_t getLastChangeMicros() {
+        return lastChangeMicros;
+    }
+    
     void setCallback(ButtonCallback callback) {
         onButtonChange = callback;
         Serial1.println("ButtonManager: Callback set");
     }
     
+    // Set gesture timing in milliseconds (0 disables double click / hold repeat)
+    void setGestureTiming(uint32_t doubleClickGapMs, uint32_t longPressMs, uint32_t repeatIntervalMs) {
+        gesture.configure(doubleClickGapMs, longPressMs, repeatIntervalMs);
+    }
+    
+    void setGestureCallback(ButtonGesture::GestureCallback callback) {
+        gesture.setCallback(callback);
+        Serial1.println("ButtonManager: Gesture callback set");
+    }
+    
     void clearCallback() {
         onButtonChange = nullptr;
         Serial1.println("ButtonManager: Callback cleared");
@@ -19,6 +19,13 @@ private:
     
     CRGB leds[NUM_LEDS];  // Array to store LED states
     
+    // Change tracking: setters only mark what changed, update() sends one
+    // show() per tick and only when something is dirty
+    uint32_t dirtyPixels;    // Bit n set = leds[n] changed since the last show()
+    static_assert(NUM_LEDS <= 32, "dirtyPixels has one bit per pixel");
+    bool brightnessDirty;    // Brightness changed since the last show()
+    uint32_t showCount;      // Frames actually sent to the LEDs
+    
     // Rainbow colors with reduced brightness
     const CRGB RAINBOW_COLORS[8] = {
         CRGB(64, 0, 0),      // Dim Red
@@ -37,16 +44,25 @@ private:
         FastLED.setMaxPowerInVoltsAndMilliamps(3, MAX_POWER * NUM_LEDS);
     }
     
-    void updatePowerSaving() {
-        if (!powerSavingMode) return;
-        
-        // Reduce brightness during power saving mode
-        FastLED.setBrightness(BRIGHTNESS / 2);
+    // Function to store a colour, marking the pixel dirty only if it changed
+    void writePixel(uint8_t index, const CRGB& color) {
+        if (leds[index] != color) {
+            leds[index] = color;
+            dirtyPixels |= 1UL << index;
+        }
+    }
+    
+    void showNow() {
+        FastLED.show();
+        dirtyPixels = 0;
+        brightnessDirty = false;
+        showCount++;
     }
 
 public:
     NeoPixelManager() : enabled(false), initialized(false),
-                       powerSavingMode(true), lastUpdate(0) {}
+                       powerSavingMode(true), lastUpdate(0),
+                       dirtyPixels(0), brightnessDirty(false), showCount(0) {}
     
     void begin() {
         if (!enabled || initialized) return;
@@ -54,13 +70,15 @@ public:
         // Initialize FastLED with power management
         FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
         setPowerLimit();
-        FastLED.setBrightness(BRIGHTNESS);
+        FastLED.setBrightness(powerSavingMode ? BRIGHTNESS / 2 : BRIGHTNESS);
+        // Temporal dithering needs continuous refreshes, frames are only sent on change
+        FastLED.setDither(DISABLE_DITHER);
         
         // Set initial rainbow pattern
         for (int i = 0; i < NUM_LEDS; i++) {
             leds[i] = RAINBOW_COLORS[i];
         }
-        FastLED.show();
+        showNow();
         
         initialized = true;
         Serial1.println("NeoPixelManager: begin: Initialized");
@@ -69,12 +87,14 @@ public:
     void update() {
         if (!enabled || !initialized) return;
         
-        // Only update LEDs periodically to save power
+        // Nothing changed, nothing to send
+        if (dirtyPixels == 0 && !brightnessDirty) return;
+        
+        // Coalesce all changes since the last frame into one show() per tick
         unsigned long currentMillis = millis();
         if (currentMillis - lastUpdate >= UPDATE_INTERVAL) {
             lastUpdate = currentMillis;
-            updatePowerSaving();
-            FastLED.show();
+            showNow();
         }
     }
     
@@ -91,7 +111,7 @@ public:
         
         // Turn off all LEDs
         FastLED.clear();
-        FastLED.show();
+        showNow();
         
         Serial1.println("NeoPixelManager: disable: Disabled");
     }
@@ -100,39 +120,43 @@ public:
         return enabled;
     }
     
-    // Set a specific LED to a specific color
+    // Set a specific LED to a specific color, shown on the next update()
     void setLED(uint8_t index, CRGB color) {
         if (index < NUM_LEDS) {
-            leds[index] = color;
-            FastLED.show();
+            writePixel(index, color);
         }
     }
     
-    // Set all LEDs to a specific color
+    // Set all LEDs to a specific color, shown on the next update()
     void setAll(CRGB color) {
         for (int i = 0; i < NUM_LEDS; i++) {
-            leds[i] = color;
+            writePixel(i, color);
         }
-        FastLED.show();
     }
     
-    // Reset to rainbow pattern
+    // Reset to rainbow pattern, shown on the next update()
     void setRainbow() {
         for (int i = 0; i < NUM_LEDS; i++) {
-            leds[i] = RAINBOW_COLORS[i];
+            writePixel(i, RAINBOW_COLORS[i]);
         }
-        FastLED.show();
     }
     
     // Enable/disable power saving mode
     void setPowerSaving(bool enable) {
+        if (powerSavingMode == enable) return;
         powerSavingMode = enable;
-        if (powerSavingMode) {
-            FastLED.setBrightness(BRIGHTNESS / 2);
-        } else {
-            FastLED.setBrightness(BRIGHTNESS);
-        }
-        FastLED.show();
+        FastLED.setBrightness(powerSavingMode ? BRIGHTNESS / 2 : BRIGHTNESS);
+        brightnessDirty = true;
+    }
+    
+    // True if changes are waiting for the next update()
+    bool isDirty() {
+        return dirtyPixels != 0 || brightnessDirty;
+    }
+    
+    // Number of frames sent to the LEDs since boot
+    uint32_t getShowCount() {
+        return showCount;
     }
     
     // Get current power saving mode
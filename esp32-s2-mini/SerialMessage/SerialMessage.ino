@@ -51,6 +51,13 @@ void onButtonStateChange(bool state) {
     Serial1.println(state ? "PRESSED" : "RELEASED");
 }
 
+// Button gesture callback function
+void onButtonGesture(ButtonGestureType gesture) {
+    Serial1.print("Button gesture: ");
+    Serial1.println(getGestureName(gesture));
+    webServerManager.recordGesture(gesture);
+}
+
 void setup() {
   // Initialize serial communication first
   Serial1.begin(115200, SERIAL_8N1, -1, 10);  // RX pin -1 means not used
@@ -91,6 +98,8 @@ void setup() {
     buttonManager.begin();
     delay(100);  // Give time for initialization
     buttonManager.setCallback(onButtonStateChange);
+    buttonManager.setGestureTiming(300, 800, 200);
+    buttonManager.setGestureCallback(onButtonGesture);
     Serial1.println("SerialMessage: setup: Button initialized");
   }
   
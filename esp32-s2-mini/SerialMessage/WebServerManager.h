@@ -8,6 +8,7 @@
 #include <WebServer.h>
 #include <HTTP_Method.h>
 #include "BatteryManager.h"
+#include "ButtonGesture.h"
 
 // HTML template for the status page - stored in PROGMEM to save RAM
 static const char PROGMEM HTML_TEMPLATE[] = R"(
@@ -42,6 +43,10 @@ static const char PROGMEM HTML_TEMPLATE[] = R"(
                     document.getElementById('battery-percentage').className = 
                         data.batteryPercentage <= 10 ? 'status critical' :
                         data.batteryPercentage <= 20 ? 'status low' : 'status';
+                    document.getElementById('battery-time').textContent = data.batteryMinutesLeft >= 0 ?
+                        Math.floor(data.batteryMinutesLeft / 60) + 'h ' + (data.batteryMinutesLeft % 60) + 'min' : '--';
+                    document.getElementById('last-gesture').textContent = data.lastGesture;
+                    document.getElementById('gesture-count').textContent = data.gestureCount;
                 });
         }
         setInterval(updateStatus, 1000);
@@ -58,6 +63,12 @@ static const char PROGMEM HTML_TEMPLATE[] = R"(
         <h2>Battery Status</h2>
         <p>Voltage: <span id="battery-voltage">--</span></p>
         <p>Level: <span id="battery-percentage" class="status">--</span></p>
+        <p>Time Left: <span id="battery-time">--</span></p>
+    </div>
+    <div class="card">
+        <h2>Button</h2>
+        <p>Last Gesture: <span id="last-gesture" class="status">--</span></p>
+        <p>Gestures: <span id="gesture-count">--</span></p>
     </div>
     <div class="card">
         <h2>WiFi Status</h2>
@@ -77,6 +88,9 @@ private:
     unsigned long lastUpdate;
     const unsigned long updateInterval = 1000; // Update every second
     BatteryManager* batteryManager;  // Reference to battery manager
+    ButtonGestureType lastGesture;   // Most recent button gesture
+    unsigned long lastGestureTime;
+    unsigned long gestureCount;
     
     void handleRoot() {
         char html[4096];  // Buffer for HTML content
@@ -96,8 +110,14 @@ private:
         if (batteryManager != nullptr && batteryManager->isEnabled()) {
             json += ",\"batteryVoltage\":" + String(batteryManager->getVoltage());
             json += ",\"batteryPercentage\":" + String(batteryManager->getPercentage());
+            json += ",\"batteryMinutesLeft\":" + String(batteryManager->getTimeToEmpty());
         }
         
+        // Add button gesture information
+        json += ",\"lastGesture\":\"" + String(getGestureName(lastGesture)) + "\"";
+        json += ",\"lastGestureTime\":" + String(lastGestureTime / 1000);
+        json += ",\"gestureCount\":" + String(gestureCount);
+        
         json += "}";
         server->send(200, "application/json", json);
     }
@@ -107,7 +127,8 @@ private:
     }
 
 public:
-    WebServerManager() : enabled(false), initialized(false), server(nullptr), batteryManager(nullptr) {}
+    WebServerManager() : enabled(false), initialized(false), server(nullptr), batteryManager(nullptr),
+                         lastGesture(GESTURE_NONE), lastGestureTime(0), gestureCount(0) {}
     
     ~WebServerManager() {
         if (server != nullptr) {
@@ -121,6 +142,12 @@ public:
         batteryManager = manager;
     }
     
+    void recordGesture(ButtonGestureType gesture) {
+        lastGesture = gesture;
+        lastGestureTime = millis();
+        gestureCount++;
+    }
+    
     void begin() {
         if (!enabled || initialized) return;
         
@@ -2,37 +2,47 @@
 #define BATTERY_MONITOR_H
 
 #include <Arduino.h>
+#include "battery_estimator.h"
 
 // Voltage divider constants
 const float R1 = 10000.0;  // 10k ohm resistor
 const float R2 = 10000.0;  // 10k ohm resistor
 const float VOLTAGE_DIVIDER_RATIO = (R1 + R2) / R2;  // Calculate voltage divider ratio
 
-// ADC constants
-const float ADC_REF_VOLTAGE = 3.3;  // ESP8266 ADC reference voltage
-const int ADC_RESOLUTION = 1023;    // 10-bit ADC resolution
+// Battery constants (single cell LiPo)
+const float BATTERY_CAPACITY_MAH = 1000.0;
+const float BATTERY_LOAD_CURRENT_MA = 80.0;  // Typical draw with WiFi connected
 
 // Battery monitoring pin
 const int BATTERY_PIN = A0;
 
-// Function to read raw ADC value
-int readBatteryRaw() {
-    return analogRead(BATTERY_PIN);
+BatteryEstimator batteryEstimator;
+
+// Function to setup battery monitoring
+void setupBatteryMonitor() {
+    batteryEstimator.begin(BATTERY_PIN, VOLTAGE_DIVIDER_RATIO, CHEMISTRY_LIPO, 1, BATTERY_CAPACITY_MAH);
+    batteryEstimator.setLoadCurrent(BATTERY_LOAD_CURRENT_MA);
+    batteryEstimator.update();
+}
+
+// Function to take a new battery reading
+void updateBatteryMonitor() {
+    batteryEstimator.update();
 }
 
-// Function to calculate actual battery voltage
+// Function to get the filtered battery voltage
 float readBatteryVoltage() {
-    int rawValue = readBatteryRaw();
-    float voltage = (rawValue * ADC_REF_VOLTAGE) / ADC_RESOLUTION;
-    return voltage * VOLTAGE_DIVIDER_RATIO;
+    return batteryEstimator.getVoltage();
 }
 
-// Function to get battery percentage (assuming 3.7V LiPo battery)
-// 3.7V = 100%, 3.3V = 0%
+// Function to get battery percentage from the LiPo discharge curve
 float getBatteryPercentage() {
-    float voltage = readBatteryVoltage();
-    float percentage = ((voltage - 3.3) / (3.7 - 3.3)) * 100.0;
-    return constrain(percentage, 0.0, 100.0);  // Constrain between 0-100%
+    return batteryEstimator.getPercentage();
+}
+
+// Function to get the estimated minutes until the battery is empty, -1 if unknown
+long getBatteryTimeToEmpty() {
+    return batteryEstimator.getTimeToEmptyMinutes();
 }
 
-#endif // BATTERY_MONITOR_H 
\ No newline at end of file
+#endif // BATTERY_MONITOR_H
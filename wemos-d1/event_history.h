@@ -0,0 +1,169 @@
+#ifndef EVENT_HISTORY_H
+#define EVENT_HISTORY_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// History configuration
+const uint16_t HISTORY_CAPACITY = 256;                // Events kept in RAM (oldest are overwritten)
+const bool ENABLE_HISTORY_PERSIST = true;             // Save history to LittleFS
+const unsigned long HISTORY_SAVE_INTERVAL = 60000;    // Save at most once a minute to limit flash wear
+const char* HISTORY_FILE = "/history.bin";
+const uint32_t HISTORY_FILE_MAGIC = 0x48495354;       // "HIST"
+
+// Event types
+enum EventType : uint8_t {
+  EVENT_BOOT = 0,
+  EVENT_BUTTON_PRESS = 1,
+  EVENT_BUTTON_RELEASE = 2,
+  EVENT_WIFI_CONNECTED = 3,
+  EVENT_WIFI_DISCONNECTED = 4,
+  EVENT_MQTT_CONNECTED = 5,
+  EVENT_MQTT_DISCONNECTED = 6
+};
+
+// One history record - this is also the binary export format (12 bytes, little-endian)
+struct __attribute__((packed)) HistoryEvent {
+  uint32_t sequence;   // Increases by one per event, gaps mean overwritten events
+  uint32_t timestamp;  // millis() at the time of the event
+  uint16_t boot;       // Boot counter, so timestamps from different boots can be told apart
+  uint8_t type;        // EventType
+  uint8_t source;      // Button index or 0
+};
+
+HistoryEvent historyEvents[HISTORY_CAPACITY];
+uint16_t historyHead = 0;       // Next slot to write
+uint16_t historyCount = 0;      // Number of valid events
+uint32_t historySequence = 0;   // Sequence number of the next event
+uint16_t historyBoot = 0;       // Current boot counter
+bool historyDirty = false;
+bool historyFsReady = false;
+unsigned long lastHistorySave = 0;
+
+// Function to get event type as string
+const char* getEventTypeName(uint8_t type) {
+  switch (type) {
+    case EVENT_BOOT: return "boot";
+    case EVENT_BUTTON_PRESS: return "button_press";
+    case EVENT_BUTTON_RELEASE: return "button_release";
+    case EVENT_WIFI_CONNECTED: return "wifi_connected";
+    case EVENT_WIFI_DISCONNECTED: return "wifi_disconnected";
+    case EVENT_MQTT_CONNECTED: return "mqtt_connected";
+    case EVENT_MQTT_DISCONNECTED: return "mqtt_disconnected";
+    default: return "unknown";
+  }
+}
+
+// Function to record an event in the history
+void recordEvent(EventType type, uint8_t source = 0, uint32_t timestamp = millis()) {
+  HistoryEvent& event = historyEvents[historyHead];
+  event.sequence = historySequence++;
+  event.timestamp = timestamp;
+  event.boot = historyBoot;
+  event.type = type;
+  event.source = source;
+
+  historyHead = (historyHead + 1) % HISTORY_CAPACITY;
+  if (historyCount < HISTORY_CAPACITY) {
+    historyCount++;
+  }
+  historyDirty = true;
+}
+
+// Function to get the n-th oldest event (0 = oldest)
+const HistoryEvent& getHistoryEvent(uint16_t index) {
+  uint16_t oldest = (historyHead + HISTORY_CAPACITY - historyCount) % HISTORY_CAPACITY;
+  return historyEvents[(oldest + index) % HISTORY_CAPACITY];
+}
+
+// Function to format one event as a CSV line, returns the line length
+int formatHistoryCsvLine(const HistoryEvent& event, char* buffer, size_t size) {
+  return snprintf(buffer, size, "%lu,%u,%lu,%s,%u\n",
+                  (unsigned long)event.sequence, event.boot,
+                  (unsigned long)event.timestamp, getEventTypeName(event.type),
+                  event.source);
+}
+
+// Function to save the history to LittleFS
+void saveHistory() {
+  if (!ENABLE_HISTORY_PERSIST || !historyFsReady || !historyDirty) return;
+
+  File file = LittleFS.open(HISTORY_FILE, "w");
+  if (!file) {
+    Serial.println("Failed to open history file for writing");
+    return;
+  }
+
+  file.write((const uint8_t*)&HISTORY_FILE_MAGIC, sizeof(HISTORY_FILE_MAGIC));
+  file.write((const uint8_t*)&historyBoot, sizeof(historyBoot));
+  file.write((const uint8_t*)&historySequence, sizeof(historySequence));
+  file.write((const uint8_t*)&historyCount, sizeof(historyCount));
+  for (uint16_t i = 0; i < historyCount; i++) {
+    file.write((const uint8_t*)&getHistoryEvent(i), sizeof(HistoryEvent));
+  }
+  file.close();
+
+  historyDirty = false;
+  lastHistorySave = millis();
+}
+
+// Function to load the history saved by a previous boot
+void loadHistory() {
+  File file = LittleFS.open(HISTORY_FILE, "r");
+  if (!file) return;
+
+  uint32_t magic = 0;
+  uint16_t count = 0;
+  file.read((uint8_t*)&magic, sizeof(magic));
+  file.read((uint8_t*)&historyBoot, sizeof(historyBoot));
+  file.read((uint8_t*)&historySequence, sizeof(historySequence));
+  file.read((uint8_t*)&count, sizeof(count));
+
+  if (magic != HISTORY_FILE_MAGIC || count > HISTORY_CAPACITY) {
+    Serial.println("History file invalid, starting fresh");
+    historyBoot = 0;
+    historySequence = 0;
+    file.close();
+    return;
+  }
+
+  for (uint16_t i = 0; i < count; i++) {
+    if (file.read((uint8_t*)&historyEvents[i], sizeof(HistoryEvent)) != sizeof(HistoryEvent)) {
+      break;
+    }
+    historyCount++;
+  }
+  historyHead = historyCount % HISTORY_CAPACITY;
+  file.close();
+
+  Serial.print("Restored ");
+  Serial.print(historyCount);
+  Serial.println(" history events");
+}
+
+// Function to setup event history
+void setupHistory() {
+  if (ENABLE_HISTORY_PERSIST) {
+    #ifdef ESP32
+      historyFsReady = LittleFS.begin(true);  // Format on first use
+    #else
+      historyFsReady = LittleFS.begin();
+    #endif
+    if (historyFsReady) {
+      loadHistory();
+      historyBoot++;
+    } else {
+      Serial.println("LittleFS mount failed, history will not be persisted");
+    }
+  }
+  recordEvent(EVENT_BOOT);
+}
+
+// Function to periodically persist the history
+void historyLoop() {
+  if (historyDirty && millis() - lastHistorySave >= HISTORY_SAVE_INTERVAL) {
+    saveHistory();
+  }
+}
+
+#endif // EVENT_HISTORY_H
@@ -6,6 +6,7 @@
 #include <ESP8266WebServer.h>
 #include <ArduinoJson.h>
 #include "battery_monitor.h"
+#include "event_history.h"
 
 // Web server port
 const int WEB_PORT = 80;
@@ -16,6 +17,7 @@ struct DeviceStatus {
     String lastButtonPressed;
     float batteryVoltage;
     float batteryPercentage;
+    long batteryMinutesLeft;
     bool isConnected;
 } deviceStatus;
 
@@ -27,6 +29,7 @@ void updateDeviceStatus(const String& buttonName) {
     deviceStatus.lastButtonPressed = buttonName;
     deviceStatus.batteryVoltage = readBatteryVoltage();
     deviceStatus.batteryPercentage = getBatteryPercentage();
+    deviceStatus.batteryMinutesLeft = getBatteryTimeToEmpty();
     deviceStatus.isConnected = true;
 }
 
@@ -47,6 +50,9 @@ void handleRoot() {
     html += "<h2 class='battery'>Battery Status</h2>";
     html += "<p>Voltage: " + String(deviceStatus.batteryVoltage, 2) + "V</p>";
     html += "<p>Percentage: " + String(deviceStatus.batteryPercentage, 1) + "%</p>";
+    if (deviceStatus.batteryMinutesLeft >= 0) {
+        html += "<p>Time left: " + String(deviceStatus.batteryMinutesLeft / 60) + "h " + String(deviceStatus.batteryMinutesLeft % 60) + "min</p>";
+    }
     html += "</div>";
     
     html += "<div class='status'>";
@@ -67,6 +73,7 @@ void handleStatus() {
     doc["lastButtonPressed"] = deviceStatus.lastButtonPressed;
     doc["batteryVoltage"] = deviceStatus.batteryVoltage;
     doc["batteryPercentage"] = deviceStatus.batteryPercentage;
+    doc["batteryMinutesLeft"] = deviceStatus.batteryMinutesLeft;
     doc["isConnected"] = deviceStatus.isConnected;
     
     String jsonString;
@@ -74,10 +81,49 @@ void handleStatus() {
     server.send(200, "application/json", jsonString);
 }
 
+// Handle history export - streams the event history in chunks
+// /history (CSV) or /history?format=bin (packed HistoryEvent records)
+void handleHistory() {
+    bool binary = server.arg("format") == "bin";
+    char chunk[512];
+    size_t used = 0;
+
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, binary ? "application/octet-stream" : "text/csv", "");
+
+    if (!binary) {
+        used = snprintf(chunk, sizeof(chunk), "sequence,boot,timestamp_ms,event,source\n");
+    }
+
+    for (uint16_t i = 0; i < historyCount; i++) {
+        const HistoryEvent& event = getHistoryEvent(i);
+        size_t length = binary ? sizeof(HistoryEvent) : 64;
+
+        // Flush the chunk when the next record might not fit
+        if (used + length > sizeof(chunk)) {
+            server.sendContent(chunk, used);
+            used = 0;
+        }
+
+        if (binary) {
+            memcpy(chunk + used, &event, sizeof(HistoryEvent));
+            used += sizeof(HistoryEvent);
+        } else {
+            used += formatHistoryCsvLine(event, chunk + used, sizeof(chunk) - used);
+        }
+    }
+
+    if (used > 0) {
+        server.sendContent(chunk, used);
+    }
+    server.sendContent("");  // Terminate the chunked response
+}
+
 // Initialize web server
 void initWebServer() {
     server.on("/", handleRoot);
     server.on("/status", handleStatus);
+    server.on("/history", handleHistory);
     server.begin();
     Serial.println("Web server started");
 }
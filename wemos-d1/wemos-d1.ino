@@ -2,6 +2,8 @@
 #include <PubSubClient.h>
 #include "battery_monitor.h"
 #include "web_server.h"
+#include "event_history.h"
+#include "input_manager.h"
 
 // Configuration
 const bool ENABLE_MQTT = false;  // Set to false to disable MQTT for testing
@@ -23,8 +25,10 @@ const char* button_topic = "wemos/button";
 const char* led_topic = "wemos/led";
 
 // Pin definitions
-const int buttonPins[] = {D0, D1, D2, D5, D6, D7};  // Array of button pins
-const int numButtons = 6;  // Number of buttons
+// Buttons on D0, D1, D2, D5, D6, D7 (HIGH when released) - masks are built at compile time
+typedef InputManager<D0, D1, D2, D5, D6, D7> ButtonInputs;
+ButtonInputs buttons;
+const int numButtons = ButtonInputs::COUNT;  // Number of buttons
 // const int ledPin = D2;     // LED pin
 
 // Button names for messagesx
@@ -37,11 +41,11 @@ const char* buttonNames[] = {
   "Button D7"
 };
 
-// Debounce settings
+// Debounce settings - a button changes after 4 stable scans
 const unsigned long DEBOUNCE_DELAY = 50;  // milliseconds
-unsigned long lastDebounceTime[numButtons] = {0};
-int lastButtonState[numButtons] = {HIGH};  // Start with HIGH since buttons are HIGH when released
-int buttonState[numButtons] = {HIGH};      // Start with HIGH since buttons are HIGH when released
+
+// Last known WiFi state for history logging
+bool lastWiFiConnected = false;
 
 WiFiClient espClient;
 PubSubClient client(espClient);
@@ -91,6 +95,7 @@ void reconnect() {
     Serial.print("Attempting MQTT connection...");
     if (client.connect(mqtt_client_id)) {
       Serial.println("connected");
+      recordEvent(EVENT_MQTT_CONNECTED);
       client.subscribe(led_topic);
     } else {
       Serial.print("failed, rc=");
@@ -101,30 +106,50 @@ void reconnect() {
   }
 }
 
+// Function to handle a debounced button change
+void handleButtonChange(uint8_t index, bool pressed) {
+  if (pressed) {
+    String message = String(buttonNames[index]) + " pressed";
+    if (ENABLE_MQTT) {
+      client.publish(button_topic, message.c_str());
+    }
+    Serial.println(message);
+    
+    // Update device status
+    updateDeviceStatus(buttonNames[index]);
+    recordEvent(EVENT_BUTTON_PRESS, index);
+  } else {
+    recordEvent(EVENT_BUTTON_RELEASE, index);
+  }
+}
+
 void setup() {
   Serial.begin(115200);
   
   // Initialize pins
-  for (int i = 0; i < numButtons; i++) {
-    pinMode(buttonPins[i], INPUT);
-    lastButtonState[i] = digitalRead(buttonPins[i]);
-    
-    if (DEBUG_INPUTS) {
+  buttons.begin(INPUT, true, DEBOUNCE_DELAY);
+  if (DEBUG_INPUTS) {
+    for (int i = 0; i < numButtons; i++) {
       Serial.print("Initial state for ");
       Serial.print(buttonNames[i]);
       Serial.print(" (pin ");
-      Serial.print(buttonPins[i]);
+      Serial.print(ButtonInputs::PINS[i]);
       Serial.print("): ");
-      Serial.println(lastButtonState[i]);
+      Serial.println(digitalRead(ButtonInputs::PINS[i]));
     }
   }
   // pinMode(ledPin, OUTPUT);
   // digitalWrite(ledPin, LOW);
   
   // Initialize battery monitoring
-  pinMode(BATTERY_PIN, INPUT);
+  setupBatteryMonitor();
+  
+  // Initialize event history (restores saved events)
+  setupHistory();
   
   setup_wifi();
+  lastWiFiConnected = true;
+  recordEvent(EVENT_WIFI_CONNECTED);
   
   // Initialize web server
   initWebServer();
@@ -136,8 +161,18 @@ void setup() {
 }
 
 void loop() {
+  // Record WiFi connection changes
+  bool wifiConnected = WiFi.status() == WL_CONNECTED;
+  if (wifiConnected != lastWiFiConnected) {
+    lastWiFiConnected = wifiConnected;
+    recordEvent(wifiConnected ? EVENT_WIFI_CONNECTED : EVENT_WIFI_DISCONNECTED);
+  }
+
   if (ENABLE_MQTT) {
     if (!client.connected()) {
+      if (client.state() == MQTT_CONNECTION_LOST) {
+        recordEvent(EVENT_MQTT_DISCONNECTED);
+      }
       reconnect();
     }
     client.loop();
@@ -145,57 +180,28 @@ void loop() {
 
   // Update web server
   updateWebServer();
+  
+  // Persist event history periodically
+  historyLoop();
 
   // Check battery periodically
   if (millis() - lastBatteryCheck >= BATTERY_CHECK_INTERVAL) {
+    updateBatteryMonitor();
     float voltage = readBatteryVoltage();
     float percentage = getBatteryPercentage();
     Serial.print("Battery Voltage: ");
     Serial.print(voltage);
     Serial.print("V (");
     Serial.print(percentage);
-    Serial.println("%)");
+    Serial.print("%, ");
+    Serial.print(getBatteryTimeToEmpty());
+    Serial.println(" min left)");
     lastBatteryCheck = millis();
     
     // Update device status
     updateDeviceStatus(deviceStatus.lastButtonPressed);
   }
 
-  // Check each button state with debouncing
-  for (int i = 0; i < numButtons; i++) {
-    int reading = digitalRead(buttonPins[i]);
-    
-    // // Debug print the raw reading
-    // Serial.print(buttonNames[i]);
-    // Serial.print(" reading: ");
-    // Serial.println(reading);
-    
-    // If the button state changed, reset the debounce timer
-    if (reading != lastButtonState[i]) {
-      lastDebounceTime[i] = millis();
-    }
-    
-    // If the reading has been stable for longer than the debounce delay
-    if ((millis() - lastDebounceTime[i]) > DEBOUNCE_DELAY) {
-      // If the button state has changed
-      if (reading != buttonState[i]) {
-        buttonState[i] = reading;
-        
-        // Trigger on button press (HIGH to LOW transition)
-        if (buttonState[i] == LOW) {
-          String message = String(buttonNames[i]) + " pressed";
-          if (ENABLE_MQTT) {
-            client.publish(button_topic, message.c_str());
-          }
-          Serial.println(message);
-          
-          // Update device status
-          updateDeviceStatus(buttonNames[i]);
-        }
-      }
-    }
-    
-    // Save the reading for next time
-    lastButtonState[i] = reading;
-  }
+  // Scan all buttons at once and handle the ones that changed
+  buttons.update(handleButtonChange);
 }
@@ -1,31 +1,98 @@
 #ifndef SLEEP_MANAGER_H
 #define SLEEP_MANAGER_H
 
-#include <ESP8266WiFi.h>
+#include <Arduino.h>
+#include <limits.h>
 
+// Power states, from awake to the lowest
+enum SleepState {
+    SLEEP_NONE = 0,     // CPU and radio fully on
+    SLEEP_MODEM,        // Radio sleeps between beacons, CPU runs
+    SLEEP_LIGHT,        // CPU paused between loops, RAM kept, wakes on timer or button
+    SLEEP_DEEP          // Everything off but RTC, wakes on button into setup()
+};
+
+const unsigned long SLEEP_NEVER = ULONG_MAX;
+
+// When to enter each state, by time since the last activity.
+// A state is skipped when the board cannot use it safely right now (see
+// BoardSleepTraits::supports), so the device ends up in the lowest safe state.
+struct SleepPolicy {
+    unsigned long modemAfterMs;     // Idle time before modem sleep
+    unsigned long lightAfterMs;     // Idle time before light sleep between loops
+    unsigned long deepAfterMs;      // Idle time before deep sleep
+    unsigned long lightSleepMs;     // Longest single light sleep (timer wake)
+    SleepState deepest;             // Lowest state this device may use
+
+    // Radio stays on, CPU never sleeps
+    static SleepPolicy alwaysOn() {
+        return {SLEEP_NEVER, SLEEP_NEVER, SLEEP_NEVER, 0, SLEEP_NONE};
+    }
+    // Mains powered with WiFi: only modem sleep
+    static SleepPolicy modemOnly(unsigned long afterMs = 0) {
+        return {afterMs, SLEEP_NEVER, SLEEP_NEVER, 0, SLEEP_MODEM};
+    }
+    // Device that must stay reachable: light sleep in short slices when idle
+    static SleepPolicy lightSleep(unsigned long afterMs, unsigned long sliceMs = 1000) {
+        return {0, afterMs, SLEEP_NEVER, sliceMs, SLEEP_LIGHT};
+    }
+    // Battery button: modem sleep at once, light sleep soon, deep sleep when idle
+    static SleepPolicy batteryButton(unsigned long lightAfterMs, unsigned long deepAfterMs) {
+        return {0, lightAfterMs, deepAfterMs, 1000, SLEEP_DEEP};
+    }
+};
+
+// Platform sleep functions; implemented per board family in SleepManager.cpp
+struct BoardSleepTraits {
+    static const char* name();
+    static void setModemSleep(bool enable);
+    // Sleep up to ms or until wakePin reads wakeLevel, returns true if woken by the pin
+    static bool lightSleep(unsigned long ms, int wakePin, int wakeLevel);
+    // Deep sleep until wakePin reads wakeLevel, does not return
+    static void deepSleep(int wakePin, int wakeLevel);
+    // True if the state is safe right now: light sleep needs the radio off (the
+    // connection is not kept), deep sleep needs a pin that can wake the chip
+    static bool supports(SleepState state, int wakePin);
+    // True if this boot is a wake from deep sleep
+    static bool wokeFromDeepSleep();
+};
+
+// Moves the device between power states according to a SleepPolicy.
+// Call resetSleepTimer() on activity and setPendingWork(true) while something must
+// not be interrupted (a transfer, an unsent message); update() goes at the end of
+// loop() and may light sleep or deep sleep there.
 class SleepManager {
 public:
-    SleepManager(int wakePin, int ledPin, unsigned long idleThreshold = 30000, unsigned long powerSaveDelay = 1000);
-    
+    SleepManager(int wakePin, int wakeLevel, const SleepPolicy& policy = SleepPolicy::modemOnly());
+
     void begin();
     void update();
-    bool isInPowerSaveMode() const { return _isPowerSaveMode; }
-    
+    void resetSleepTimer();
+    void setPendingWork(bool pending);
+    void setPolicy(const SleepPolicy& policy);
+    // Called before light and deep sleep, e.g. to turn LEDs off
+    void setBeforeSleepCallback(void (*callback)(SleepState));
+
+    SleepState getState() const { return _state; }
+    SleepState getDeepestState() const;
+    unsigned long getIdleTime() const { return millis() - _lastActivityTime; }
+    bool wokeByButton() const { return _wokeByButton; }
+    static bool wokeFromDeepSleep() { return BoardSleepTraits::wokeFromDeepSleep(); }
+    static const char* getStateName(SleepState state);
+
 private:
-    void enterPowerSaveMode();
-    void exitPowerSaveMode();
-    
+    bool isAllowed(SleepState state) const;
+    SleepState targetState() const;
+    void setState(SleepState state);
+
     const int _wakePin;
-    const int _ledPin;
-    const unsigned long _idleThreshold;
-    const unsigned long _powerSaveDelay;
-    
+    const int _wakeLevel;
+    SleepPolicy _policy;
+    SleepState _state;
     unsigned long _lastActivityTime;
-    unsigned long _lastDebugTime;
-    bool _isPowerSaveMode;
-    
-    static const int UNUSED_PINS[];
-    static const int NUM_UNUSED_PINS;
+    bool _pendingWork;
+    bool _wokeByButton;
+    void (*_beforeSleepCallback)(SleepState);
 };
 
-#endif // SLEEP_MANAGER_H 
\ No newline at end of file
+#endif // SLEEP_MANAGER_H
@@ -2,11 +2,36 @@
 #include "SleepManager.h"
 
 // Pin definitions
-const int WAKE_PIN = D0;  // Button connected to D0
+const int WAKE_PIN = D5;  // Button between D5 (GPIO14) and GND; D0 (GPIO16) cannot wake light sleep
 const int LED_PIN = D4;   // Onboard LED pin
+const unsigned long LED_PULSE_MS = 1000;  // LED on time per press
 
-// Create sleep manager instance
-SleepManager sleepManager(WAKE_PIN, LED_PIN);
+// Pins not used by this sketch, left floating as inputs to save power
+const int UNUSED_PINS[] = {D0, D1, D2, D3, D6, D7, D8};
+
+// Forced light sleep after 30 seconds of inactivity; the button wakes it at once,
+// the timer only every minute
+SleepManager sleepManager(WAKE_PIN, LOW, SleepPolicy::lightSleep(30000, 60000));
+
+unsigned long lastDebugTime = 0;
+bool lastButtonPressed = false;
+bool ledPulseActive = false;
+unsigned long ledPulseStart = 0;
+
+// Function to light the LED for LED_PULSE_MS without blocking
+void startLedPulse() {
+  digitalWrite(LED_PIN, LOW);  // Turn LED on (LOW turns it on for Wemos D1)
+  ledPulseActive = true;
+  ledPulseStart = millis();
+}
+
+// Function to turn the LED off once the pulse is over
+void updateLedPulse() {
+  if (ledPulseActive && millis() - ledPulseStart >= LED_PULSE_MS) {
+    digitalWrite(LED_PIN, HIGH); // Turn LED off
+    ledPulseActive = false;
+  }
+}
 
 void setup() {
   // Disable WiFi to save power
@@ -17,9 +42,48 @@ void setup() {
   Serial.begin(9600);
   Serial.println("Device starting...");
   
+  // Configure wake-up pin
+  pinMode(WAKE_PIN, INPUT_PULLUP);
+  pinMode(LED_PIN, OUTPUT);
+  digitalWrite(LED_PIN, HIGH);  // LED off
+  
+  // Configure unused pins for power saving
+  for (int pin : UNUSED_PINS) {
+    pinMode(pin, INPUT);  // Set as input without pull-up
+  }
+  
   sleepManager.begin();
+  lastDebugTime = millis();
 }
 
 void loop() {
+  // Feed the watchdog timer
+  ESP.wdtFeed();
+  
+  // Check if button is pressed (LOW because of INPUT_PULLUP). A press that woke the
+  // board counts even if the button was released before this read.
+  bool buttonPressed = digitalRead(WAKE_PIN) == LOW;
+  if ((buttonPressed && !lastButtonPressed) || sleepManager.wokeByButton()) {
+    Serial.println("Button pressed!");
+    startLedPulse();
+    sleepManager.resetSleepTimer();  // Reset the activity timer
+  }
+  lastButtonPressed = buttonPressed;
+  
+  // Keep the CPU awake while the LED pulse runs
+  updateLedPulse();
+  sleepManager.setPendingWork(ledPulseActive);
+  
+  // Print uptime while active
+  if (sleepManager.getState() < SLEEP_LIGHT && millis() - lastDebugTime >= 5000) {
+    Serial.print("Uptime: ");
+    Serial.print(millis() / 1000);
+    Serial.println(" seconds");
+    lastDebugTime = millis();
+  }
+  
+  // Enter the lowest power state the policy allows
   sleepManager.update();
+  
+  delay(10);  // Normal operation delay
 }
@@ -0,0 +1,256 @@
+#include "SleepManager.h"
+
+#if defined(ESP32)
+  #include <WiFi.h>
+  #include <esp_sleep.h>
+  #include <esp_system.h>
+  #include <driver/gpio.h>
+  #include <driver/rtc_io.h>
+#elif defined(ARDUINO_ARCH_ESP8266)
+  #include <ESP8266WiFi.h>
+  extern "C" {
+    #include <user_interface.h>
+  }
+#endif
+
+// ---- Board traits ----
+
+#if defined(ESP32)
+
+const char* BoardSleepTraits::name() {
+    return "ESP32";
+}
+
+void BoardSleepTraits::setModemSleep(bool enable) {
+    // Only meaningful with the radio on; WIFI_PS_MIN_MODEM wakes for every DTIM beacon
+    if (WiFi.getMode() != WIFI_OFF) {
+        WiFi.setSleep(enable);
+    }
+}
+
+bool BoardSleepTraits::lightSleep(unsigned long ms, int wakePin, int wakeLevel) {
+    if (wakePin >= 0) {
+        gpio_wakeup_enable((gpio_num_t)wakePin, wakeLevel == HIGH ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+    }
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    Serial.flush();
+    esp_light_sleep_start();
+
+    bool byPin = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    if (wakePin >= 0) {
+        gpio_wakeup_disable((gpio_num_t)wakePin);
+    }
+    return byPin;
+}
+
+void BoardSleepTraits::deepSleep(int wakePin, int wakeLevel) {
+    #if SOC_PM_SUPPORT_EXT0_WAKEUP
+        // Chips with RTC GPIOs (ESP32, S2, S3): the pin stays biased through the RTC domain
+        rtc_gpio_pullup_dis((gpio_num_t)wakePin);
+        rtc_gpio_pulldown_dis((gpio_num_t)wakePin);
+        if (wakeLevel == HIGH) {
+            rtc_gpio_pulldown_en((gpio_num_t)wakePin);
+        } else {
+            rtc_gpio_pullup_en((gpio_num_t)wakePin);
+        }
+        esp_sleep_enable_ext0_wakeup((gpio_num_t)wakePin, wakeLevel);
+    #else
+        // Chips without RTC GPIOs (C3, C6): digital GPIO wake
+        esp_deep_sleep_enable_gpio_wakeup(1ULL << wakePin,
+            wakeLevel == HIGH ? ESP_GPIO_WAKEUP_GPIO_HIGH : ESP_GPIO_WAKEUP_GPIO_LOW);
+    #endif
+    Serial.flush();
+    esp_deep_sleep_start();
+}
+
+bool BoardSleepTraits::supports(SleepState state, int wakePin) {
+    switch (state) {
+        case SLEEP_LIGHT: return WiFi.getMode() == WIFI_OFF;
+        case SLEEP_DEEP: return wakePin >= 0 && esp_sleep_is_valid_wakeup_gpio((gpio_num_t)wakePin);
+        default: return true;
+    }
+}
+
+bool BoardSleepTraits::wokeFromDeepSleep() {
+    return esp_reset_reason() == ESP_RST_DEEPSLEEP;
+}
+
+#elif defined(ARDUINO_ARCH_ESP8266)
+
+const char* BoardSleepTraits::name() {
+    return "ESP8266";
+}
+
+void BoardSleepTraits::setModemSleep(bool enable) {
+    if (WiFi.getMode() != WIFI_OFF) {
+        WiFi.setSleepMode(enable ? WIFI_MODEM_SLEEP : WIFI_NONE_SLEEP);
+    }
+}
+
+static volatile bool lightSleepWoke = false;
+static volatile bool lightSleepPinWake = false;
+static int lightSleepWakePin = -1;
+static int lightSleepWakeLevel = HIGH;
+
+// Runs as soon as the chip wakes; the pin is read here, before a short press can be
+// released, to tell a button wake from the timer
+static void onLightSleepWake() {
+    lightSleepPinWake = lightSleepWakePin >= 0 && digitalRead(lightSleepWakePin) == lightSleepWakeLevel;
+    lightSleepWoke = true;
+}
+
+bool BoardSleepTraits::lightSleep(unsigned long ms, int wakePin, int wakeLevel) {
+    // Forced light sleep; the CPU stops until the timer fires or the pin reaches its
+    // level. GPIO16 cannot wake light sleep, a button there only gets the timer.
+    bool pinWake = wakePin >= 0 && wakePin < 16;
+    wifi_set_opmode_current(NULL_MODE);
+    wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+    wifi_fpm_open();
+    if (pinWake) {
+        gpio_pin_wakeup_enable(GPIO_ID_PIN(wakePin), wakeLevel == HIGH ? GPIO_PIN_INTR_HILEVEL : GPIO_PIN_INTR_LOLEVEL);
+    }
+    lightSleepWoke = false;
+    lightSleepPinWake = false;
+    lightSleepWakePin = pinWake ? wakePin : -1;
+    lightSleepWakeLevel = wakeLevel;
+    wifi_fpm_set_wakeup_cb(onLightSleepWake);
+    Serial.flush();
+    wifi_fpm_do_sleep(ms * 1000);
+
+    // Sleep starts in the idle task; millis() stands still while asleep, so this only
+    // counts awake time and ends at once after a wake (or after ms if sleep failed)
+    for (unsigned long waited = 0; !lightSleepWoke && waited <= ms; waited++) {
+        delay(1);
+    }
+    if (pinWake) {
+        gpio_pin_wakeup_disable();
+    }
+    wifi_fpm_close();
+    return lightSleepPinWake;
+}
+
+void BoardSleepTraits::deepSleep(int wakePin, int wakeLevel) {
+    // Only RST can wake the ESP8266 from deep sleep, supports() never allows it
+    ESP.deepSleep(0);
+}
+
+bool BoardSleepTraits::supports(SleepState state, int wakePin) {
+    switch (state) {
+        case SLEEP_LIGHT: return WiFi.getMode() == WIFI_OFF;
+        case SLEEP_DEEP: return false;
+        default: return true;
+    }
+}
+
+bool BoardSleepTraits::wokeFromDeepSleep() {
+    return ESP.getResetInfoPtr()->reason == REASON_DEEP_SLEEP_AWAKE;
+}
+
+#else
+  #error "SleepManager: no BoardSleepTraits for this board"
+#endif
+
+// ---- SleepManager ----
+
+SleepManager::SleepManager(int wakePin, int wakeLevel, const SleepPolicy& policy) :
+    _wakePin(wakePin),
+    _wakeLevel(wakeLevel),
+    _policy(policy),
+    _state(SLEEP_NONE),
+    _lastActivityTime(0),
+    _pendingWork(false),
+    _wokeByButton(false),
+    _beforeSleepCallback(nullptr) {
+}
+
+void SleepManager::begin() {
+    resetSleepTimer();
+    Serial.printf("Sleep Manager initialized (%s, deepest state: %s)\n",
+                  BoardSleepTraits::name(), getStateName(getDeepestState()));
+}
+
+void SleepManager::setPolicy(const SleepPolicy& policy) {
+    _policy = policy;
+}
+
+void SleepManager::setBeforeSleepCallback(void (*callback)(SleepState)) {
+    _beforeSleepCallback = callback;
+}
+
+void SleepManager::resetSleepTimer() {
+    _lastActivityTime = millis();
+}
+
+void SleepManager::setPendingWork(bool pending) {
+    _pendingWork = pending;
+}
+
+bool SleepManager::isAllowed(SleepState state) const {
+    return state <= _policy.deepest && BoardSleepTraits::supports(state, _wakePin);
+}
+
+SleepState SleepManager::getDeepestState() const {
+    for (int state = SLEEP_DEEP; state > SLEEP_NONE; state--) {
+        if (isAllowed((SleepState)state)) return (SleepState)state;
+    }
+    return SLEEP_NONE;
+}
+
+const char* SleepManager::getStateName(SleepState state) {
+    switch (state) {
+        case SLEEP_NONE: return "awake";
+        case SLEEP_MODEM: return "modem sleep";
+        case SLEEP_LIGHT: return "light sleep";
+        case SLEEP_DEEP: return "deep sleep";
+        default: return "unknown";
+    }
+}
+
+SleepState SleepManager::targetState() const {
+    if (_pendingWork) return SLEEP_NONE;
+
+    unsigned long idle = getIdleTime();
+    if (isAllowed(SLEEP_DEEP) && idle >= _policy.deepAfterMs) return SLEEP_DEEP;
+    if (isAllowed(SLEEP_LIGHT) && idle >= _policy.lightAfterMs) return SLEEP_LIGHT;
+    if (isAllowed(SLEEP_MODEM) && idle >= _policy.modemAfterMs) return SLEEP_MODEM;
+    return SLEEP_NONE;
+}
+
+void SleepManager::setState(SleepState state) {
+    if (state == _state) return;
+
+    // Modem sleep is the base of every sleeping state
+    bool modem = state >= SLEEP_MODEM;
+    if (modem != (_state >= SLEEP_MODEM)) {
+        BoardSleepTraits::setModemSleep(modem);
+    }
+    Serial.print("Sleep Manager: ");
+    Serial.println(getStateName(state));
+    _state = state;
+}
+
+void SleepManager::update() {
+    SleepState target = targetState();
+    setState(target);
+    _wokeByButton = false;
+
+    if (target == SLEEP_DEEP) {
+        if (_beforeSleepCallback != nullptr) _beforeSleepCallback(SLEEP_DEEP);
+        BoardSleepTraits::deepSleep(_wakePin, _wakeLevel);
+    } else if (target == SLEEP_LIGHT) {
+        // Do not sleep past the point where deep sleep becomes due
+        unsigned long ms = _policy.lightSleepMs;
+        if (_policy.deepAfterMs != SLEEP_NEVER && isAllowed(SLEEP_DEEP)) {
+            unsigned long untilDeep = _policy.deepAfterMs - getIdleTime();
+            if (untilDeep < ms) ms = untilDeep + 1;
+        }
+        if (_beforeSleepCallback != nullptr) _beforeSleepCallback(SLEEP_LIGHT);
+        _wokeByButton = BoardSleepTraits::lightSleep(ms, _wakePin, _wakeLevel);
+        if (_wokeByButton) {
+            resetSleepTimer();
+            setState(targetState());
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef BATTERY_SAMPLER_H
+#define BATTERY_SAMPLER_H
+
+#include <Arduino.h>
+
+// Background battery sampler.
+// One ADC reading is taken every BATTERY_SAMPLE_INTERVAL from loop(), so no caller
+// ever waits on the ADC. Each reading goes through a median of the last three (drops
+// single spikes from WiFi transmit bursts) and an exponential moving average. The
+// result is cached; getBatteryVoltage() only returns the cached value.
+
+const int BATTERY_PIN = A0; // Battery voltage divider connected to A0
+const float VOLTAGE_DIVIDER_RATIO = 1.75; // Calibrated ratio based on actual ADC voltage
+const float REFERENCE_VOLTAGE = 3.3; // ESP32C3 reference voltage
+
+// Battery voltage thresholds
+const float BATTERY_FULL = 4.2;    // Fully charged
+const float BATTERY_GOOD = 3.7;    // Good charge
+const float BATTERY_LOW = 3.3;     // Low battery
+const float BATTERY_CRITICAL = 3.0; // Critical low
+
+const unsigned long BATTERY_SAMPLE_INTERVAL = 2000;  // One reading every 2 seconds
+const float BATTERY_FILTER_ALPHA = 0.25;             // Weight of a new reading in the average
+
+// Sampler state
+int batteryRecent[3] = {0, 0, 0};   // Last three raw readings for the median
+uint8_t batteryRecentIndex = 0;
+float batteryVoltage = 0.0;         // Filtered voltage, the cached value
+unsigned long lastBatterySample = 0;
+uint32_t batterySamples = 0;
+
+// Function to get battery status
+const char* getBatteryStatus(float voltage) {
+  if (voltage >= BATTERY_FULL) return "FULL";
+  if (voltage >= BATTERY_GOOD) return "GOOD";
+  if (voltage >= BATTERY_LOW) return "LOW";
+  if (voltage >= BATTERY_CRITICAL) return "CRITICAL";
+  return "DANGER";
+}
+
+// Function to convert a raw ADC reading to the battery voltage
+float rawToBatteryVoltage(int raw) {
+  return (raw * REFERENCE_VOLTAGE * VOLTAGE_DIVIDER_RATIO) / 4095.0;
+}
+
+int medianOfThree(int a, int b, int c) {
+  if (a > b) { int t = a; a = b; b = t; }
+  if (b > c) { b = c; }
+  return a > b ? a : b;
+}
+
+// Function to take one reading and fold it into the filtered value
+void sampleBattery() {
+  batteryRecent[batteryRecentIndex] = analogRead(BATTERY_PIN);
+  batteryRecentIndex = (batteryRecentIndex + 1) % 3;
+  float voltage = rawToBatteryVoltage(medianOfThree(batteryRecent[0], batteryRecent[1], batteryRecent[2]));
+  batteryVoltage += BATTERY_FILTER_ALPHA * (voltage - batteryVoltage);
+  batterySamples++;
+}
+
+// Function to seed the filter so the cache is valid from the start
+void setupBatterySampler() {
+  pinMode(BATTERY_PIN, INPUT);
+  for (int i = 0; i < 3; i++) {
+    batteryRecent[i] = analogRead(BATTERY_PIN);
+  }
+  batteryVoltage = rawToBatteryVoltage(medianOfThree(batteryRecent[0], batteryRecent[1], batteryRecent[2]));
+  lastBatterySample = millis();
+}
+
+// Function to take a reading when one is due, call from loop().
+// Returns true when the cached value was updated.
+bool batterySamplerLoop() {
+  if (millis() - lastBatterySample < BATTERY_SAMPLE_INTERVAL) {
+    return false;
+  }
+  lastBatterySample = millis();
+  sampleBattery();
+  return true;
+}
+
+// Function to get the filtered battery voltage, never touches the ADC
+float getBatteryVoltage() {
+  return batteryVoltage;
+}
+
+#endif // BATTERY_SAMPLER_H
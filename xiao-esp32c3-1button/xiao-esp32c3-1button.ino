@@ -2,19 +2,15 @@
 // Button connected to D10 and 3.3V
 // Battery voltage divider connected to A0 (2x 10k resistors)
 
-#include "sleep_manager.h"
+#include "SleepManager.h"
 #include "wifi_manager.h"
+#include "battery_sampler.h"
 
 const int BUTTON_PIN = 10;  // Button connected to D10
-const int BATTERY_PIN = A0; // Battery voltage divider connected to A0
-const float VOLTAGE_DIVIDER_RATIO = 1.75; // Calibrated ratio based on actual ADC voltage
-const float REFERENCE_VOLTAGE = 3.3; // ESP32C3 reference voltage
 
-// Battery voltage thresholds
-const float BATTERY_FULL = 4.2;    // Fully charged
-const float BATTERY_GOOD = 3.7;    // Good charge
-const float BATTERY_LOW = 3.3;     // Low battery
-const float BATTERY_CRITICAL = 3.0; // Critical low
+// Modem sleep from startup: the web server keeps WiFi on, so light sleep is not
+// allowed, and D10 (GPIO10) cannot wake the C3 from deep sleep
+SleepManager sleepManager(BUTTON_PIN, HIGH, SleepPolicy::modemOnly());
 
 // Button debouncing variables
 unsigned long lastDebounceTime = 0;
@@ -26,10 +22,13 @@ int reading = LOW;                   // Raw reading from button
 void setup() {
   Serial.begin(115200);
   pinMode(BUTTON_PIN, INPUT_PULLDOWN); // Enable internal pull-down resistor
-  pinMode(BATTERY_PIN, INPUT);
+  
+  // Seed the battery filter, after this the battery is only read in the background
+  setupBatterySampler();
+  updateBatteryStatus(getBatteryVoltage(), getBatteryStatus(getBatteryVoltage()));
   
   // Initialize sleep functionality
-  initSleep(BUTTON_PIN);
+  sleepManager.begin();
   
   // Initialize WiFi
   initWiFi();
@@ -38,25 +37,16 @@ void setup() {
   // Print initial state
   Serial.println("System initialized");
   Serial.println("Press button to read battery voltage");
-  Serial.println("Device will sleep after 30 seconds of inactivity");
-}
-
-// Function to get battery status
-String getBatteryStatus(float voltage) {
-  if (voltage >= BATTERY_FULL) return "FULL";
-  if (voltage >= BATTERY_GOOD) return "GOOD";
-  if (voltage >= BATTERY_LOW) return "LOW";
-  if (voltage >= BATTERY_CRITICAL) return "CRITICAL";
-  return "DANGER";
+  Serial.println("WiFi modem sleep is on, the web server stays reachable");
 }
 
 void loop() {
   // Handle web server requests
   handleWebServer();
   
-  // Check if it's time to sleep
-  if (shouldSleep()) {
-    goToSleep();
+  // Sample the battery when due and refresh the web server's value
+  if (batterySamplerLoop()) {
+    updateBatteryStatus(getBatteryVoltage(), getBatteryStatus(getBatteryVoltage()));
   }
   
   // Read the current button state
@@ -76,36 +66,17 @@ void loop() {
       // If the button is pressed (HIGH)
       if (buttonState == HIGH) {
         // Reset sleep timer
-        resetSleepTimer();
-        
-        // Read battery voltage multiple times and average
-        float totalVoltage = 0;
-        const int numReadings = 5;
+        sleepManager.resetSleepTimer();
         
-        for(int i = 0; i < numReadings; i++) {
-          int rawValue = analogRead(BATTERY_PIN);
-          float voltage = (rawValue * REFERENCE_VOLTAGE * VOLTAGE_DIVIDER_RATIO) / 4095.0;
-          totalVoltage += voltage;
-          
-          // Print raw ADC value for debugging
-          Serial.print("Raw ADC value: ");
-          Serial.println(rawValue);
-          
-          delay(10); // Small delay between readings
-        }
-        
-        float averageVoltage = totalVoltage / numReadings;
-        String status = getBatteryStatus(averageVoltage);
+        // Report the cached battery voltage, the ADC is sampled in the background
+        float voltage = getBatteryVoltage();
         
         // Print battery voltage and status
         Serial.print("Battery Voltage: ");
-        Serial.print(averageVoltage);
+        Serial.print(voltage);
         Serial.print("V (");
-        Serial.print(status);
+        Serial.print(getBatteryStatus(voltage));
         Serial.println(")");
-        
-        // Update web server with new reading
-        updateBatteryStatus(averageVoltage, status);
       }
     }
   }
@@ -113,5 +84,8 @@ void loop() {
   // Save the current button state for the next comparison
   lastButtonState = reading;
   
+  // Enter the lowest power state the policy allows
+  sleepManager.update();
+  
   delay(10); // Small delay to prevent CPU hogging
 } 
\ No newline at end of file
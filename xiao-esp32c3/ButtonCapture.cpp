@@ -0,0 +1,117 @@
+#include "ButtonCapture.h"
+
+ButtonCapture::ButtonCapture() :
+    _head(0),
+    _tail(0),
+    _droppedEdges(0),
+    _pin(0),
+    _activeHigh(true),
+    _debounceUs(50000),
+    _attached(false),
+    _stableLevel(false),
+    _burstActive(false),
+    _burstStartUs(0),
+    _burstLastUs(0),
+    _burstLevel(false) {
+}
+
+// Pin mode must already be configured
+void ButtonCapture::begin(uint8_t pin, bool pressedLevel, uint32_t debounceMicros) {
+    _pin = pin;
+    _activeHigh = pressedLevel;
+    _debounceUs = debounceMicros;
+    _stableLevel = digitalRead(_pin);
+    _burstActive = false;
+    _head.store(0);
+    _tail.store(0);
+    attachInterruptArg(digitalPinToInterrupt(_pin), handleInterrupt, this, CHANGE);
+    _attached = true;
+}
+
+void ButtonCapture::end() {
+    if (!_attached) {
+        return;
+    }
+    detachInterrupt(digitalPinToInterrupt(_pin));
+    _attached = false;
+}
+
+void IRAM_ATTR ButtonCapture::handleInterrupt(void* arg) {
+    ButtonCapture* self = static_cast<ButtonCapture*>(arg);
+    uint8_t head = self->_head.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) & QUEUE_MASK;
+
+    if (next == self->_tail.load(std::memory_order_acquire)) {
+        self->_droppedEdges = self->_droppedEdges + 1;
+        return;
+    }
+
+    self->_queue[head].timestampUs = micros();
+    self->_queue[head].level = digitalRead(self->_pin);
+    self->_head.store(next, std::memory_order_release);
+}
+
+// Returns true if the settled burst changed the debounced level
+bool ButtonCapture::settleBurst(bool level) {
+    _burstActive = false;
+    if (level == _stableLevel) {
+        return false;
+    }
+    _stableLevel = level;
+    return true;
+}
+
+// Get the next debounced change, call from loop() until it returns false.
+// timestampUs is the micros() time of the first edge of the change.
+bool ButtonCapture::nextChange(bool& pressed, uint32_t& timestampUs) {
+    if (!_attached) {
+        return false;
+    }
+
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    uint8_t head = _head.load(std::memory_order_acquire);
+
+    while (tail != head) {
+        Edge edge = _queue[tail];
+
+        // A quiet gap longer than the debounce time ends the previous burst
+        if (_burstActive && (edge.timestampUs - _burstLastUs) >= _debounceUs) {
+            uint32_t startUs = _burstStartUs;
+            if (settleBurst(_burstLevel)) {
+                // Leave this edge queued, it starts the next burst
+                pressed = _stableLevel == _activeHigh;
+                timestampUs = startUs;
+                return true;
+            }
+        }
+
+        tail = (tail + 1) & QUEUE_MASK;
+        _tail.store(tail, std::memory_order_release);
+
+        if (!_burstActive) {
+            _burstActive = true;
+            _burstStartUs = edge.timestampUs;
+        }
+        _burstLastUs = edge.timestampUs;
+        _burstLevel = edge.level;
+    }
+
+    // The last burst settles once the pin has been quiet long enough;
+    // the pin itself is the most reliable final level
+    if (_burstActive && (micros() - _burstLastUs) >= _debounceUs) {
+        if (settleBurst(digitalRead(_pin))) {
+            pressed = _stableLevel == _activeHigh;
+            timestampUs = _burstStartUs;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ButtonCapture::isPressed() {
+    return _stableLevel == _activeHigh;
+}
+
+uint32_t ButtonCapture::getDroppedEdges() {
+    return _droppedEdges;
+}
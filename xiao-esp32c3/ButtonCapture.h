@@ -0,0 +1,49 @@
+#ifndef BUTTON_CAPTURE_H
+#define BUTTON_CAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Interrupt-driven button capture.
+// The GPIO interrupt timestamps every edge with micros() into a single-producer/
+// single-consumer ring buffer; nextChange() drains it from loop() and debounces, so
+// a long stall in loop() delays a press but never loses it.
+class ButtonCapture {
+public:
+    ButtonCapture();
+    void begin(uint8_t pin, bool pressedLevel, uint32_t debounceMicros);
+    void end();
+    bool nextChange(bool& pressed, uint32_t& timestampUs);
+    bool isPressed();
+    uint32_t getDroppedEdges();
+
+private:
+    struct Edge {
+        uint32_t timestampUs;
+        uint8_t level;
+    };
+
+    static const uint8_t QUEUE_SIZE = 32;  // Must be a power of two
+    static const uint8_t QUEUE_MASK = QUEUE_SIZE - 1;
+
+    Edge _queue[QUEUE_SIZE];
+    std::atomic<uint8_t> _head;   // Written by the ISR only
+    std::atomic<uint8_t> _tail;   // Written by nextChange() only
+    volatile uint32_t _droppedEdges;
+
+    uint8_t _pin;
+    bool _activeHigh;
+    uint32_t _debounceUs;
+    bool _attached;
+
+    bool _stableLevel;        // Last debounced level
+    bool _burstActive;        // An edge burst is waiting to settle
+    uint32_t _burstStartUs;   // First edge of the burst
+    uint32_t _burstLastUs;    // Most recent edge of the burst
+    bool _burstLevel;         // Level after the most recent edge
+
+    static void handleInterrupt(void* arg);
+    bool settleBurst(bool level);
+};
+
+#endif // BUTTON_CAPTURE_H
@@ -1,8 +1,9 @@
 #include "WiFiManager.h"
 #include "WebServerManager.h"
 #include "MQTTManager.h"
-// #include "SleepManager.h"
+#include "SleepManager.h"
 #include "Config_device.h"
+#include "ButtonCapture.h"
 
 // Pin definitions
 const int BUTTON_PIN = D10;  // Button connected to D10
@@ -12,12 +13,13 @@ const int LED_PIN = D9;      // LED connected to D9
 WiFiManager wifiManager;
 WebServerManager webServer;
 MQTTManager mqttManager;
-// SleepManager sleepManager;  // Temporarily disabled
+// Modem sleep: WiFi stays on, so light sleep is not allowed, and D10 (GPIO10) cannot
+// wake the C3 from deep sleep. With the button on D1-D3 (GPIO3-5) use
+// SleepPolicy::batteryButton(30000, 60000) to deep sleep after a minute idle.
+SleepManager sleepManager(BUTTON_PIN, HIGH, SleepPolicy::modemOnly());
 
-// Button state variables
-int lastButtonState = LOW;   // Previous button state
-int buttonState = LOW;       // Current button state
-unsigned long lastDebounceTime = 0;  // Last time the button state changed
+// Button capture (interrupt-driven, debounced in loop)
+ButtonCapture buttonCapture;
 const unsigned long debounceDelay = 50;  // Debounce time in milliseconds
 
 // LED control callback
@@ -25,7 +27,12 @@ void handleLEDControl(bool state) {
     digitalWrite(LED_PIN, state ? HIGH : LOW);
     webServer.setLEDState(state);
     Serial.println(state ? "LED turned ON via MQTT" : "LED turned OFF via MQTT");
-    // sleepManager.resetSleepTimer();  // Temporarily disabled
+    sleepManager.resetSleepTimer();
+}
+
+// Called before the device sleeps
+void handleBeforeSleep(SleepState state) {
+    digitalWrite(LED_PIN, LOW);
 }
 
 void setup() {
@@ -44,6 +51,7 @@ void setup() {
   
   // Configure button pin as input with internal pull-down
   pinMode(BUTTON_PIN, INPUT);
+  buttonCapture.begin(BUTTON_PIN, HIGH, debounceDelay * 1000);
   
   // Configure LED pin as output
   pinMode(LED_PIN, OUTPUT);
@@ -62,7 +70,8 @@ void setup() {
   mqttManager.setLEDCallback(handleLEDControl);
   
   // Initialize sleep manager
-  // sleepManager.begin();  // Temporarily disabled
+  sleepManager.setBeforeSleepCallback(handleBeforeSleep);
+  sleepManager.begin();
   
   // Connect to WiFi
   if (wifiManager.connect()) {
@@ -83,40 +92,27 @@ void loop() {
   // Handle MQTT
   mqttManager.loop();
   
-  // Handle sleep management
-  // sleepManager.loop();  // Temporarily disabled
-  
-  // Read the current button state
-  int reading = digitalRead(BUTTON_PIN);
-  
-  // Check if the button state has changed
-  if (reading != lastButtonState) {
-    lastDebounceTime = millis();
-  }
-  
-  // If the button state has been stable for longer than the debounce delay
-  if ((millis() - lastDebounceTime) > debounceDelay) {
-    // If the button state has changed
-    if (reading != buttonState) {
-      buttonState = reading;
-      
-      // Toggle LED when button is pressed
-      if (buttonState == HIGH) {
-        digitalWrite(LED_PIN, HIGH);
-        webServer.setLEDState(true);
-        Serial.println("Button pressed - LED ON");
-        // Publish button press to MQTT
-        mqttManager.publishButtonPress();
-        // Reset sleep timer on button press
-        // sleepManager.resetSleepTimer();  // Temporarily disabled
-      } else {
-        digitalWrite(LED_PIN, LOW);
-        webServer.setLEDState(false);
-        Serial.println("Button released - LED OFF");
-      }
+  // Handle every debounced button change captured since the last loop
+  bool pressed;
+  uint32_t pressMicros;
+  while (buttonCapture.nextChange(pressed, pressMicros)) {
+    // Toggle LED when button is pressed
+    if (pressed) {
+      digitalWrite(LED_PIN, HIGH);
+      webServer.setLEDState(true);
+      Serial.printf("Button pressed - LED ON (handled %lu us after press)\n",
+                    (unsigned long)(micros() - pressMicros));
+      // Publish button press to MQTT
+      mqttManager.publishButtonPress();
+      // Reset sleep timer on button press
+      sleepManager.resetSleepTimer();
+    } else {
+      digitalWrite(LED_PIN, LOW);
+      webServer.setLEDState(false);
+      Serial.println("Button released - LED OFF");
     }
   }
-  
-  // Save the current button state for the next comparison
-  lastButtonState = reading;
-}
+
+  // Enter the lowest power state the policy allows
+  sleepManager.update();
+}
\ No newline at end of file
@@ -3,44 +3,40 @@
 
 #include <Arduino.h>
 #include "pin_definitions.h"
+#include "battery_estimator.h"
 
 // Battery status structure
 struct BatteryStatus {
   float voltage;
   int percentage;
+  long minutesLeft;  // Estimated time to empty, -1 if unknown
   bool isLow;
 };
 
-BatteryStatus batteryStatus = {0.0, 0, false};
+BatteryStatus batteryStatus = {0.0, 0, -1, false};
+BatteryEstimator batteryEstimator;
 
-// Function to read battery voltage
+// Function to read battery voltage (filtered, calibrated)
 float readBatteryVoltage() {
   #if defined(ARDUINO_XIAO_ESP32S3)
-    // Read ADC value
-    int adcValue = analogRead(batteryPin);
-    // Convert to voltage (ESP32S3 ADC is 12-bit, reference voltage is 3.3V)
-    float voltage = (adcValue * 3.3) / 4095.0;
-    // Apply voltage divider ratio
-    return voltage * VOLTAGE_DIVIDER_RATIO;
+    return batteryEstimator.getVoltage();
   #else
     return 0.0;  // No battery monitoring on ESP32C3
   #endif
 }
 
-// Function to calculate battery percentage
-int calculateBatteryPercentage(float voltage) {
-  if (voltage <= MIN_BATTERY_VOLTAGE) return 0;
-  if (voltage >= MAX_BATTERY_VOLTAGE) return 100;
-  
-  return (int)((voltage - MIN_BATTERY_VOLTAGE) * 100.0 / 
-               (MAX_BATTERY_VOLTAGE - MIN_BATTERY_VOLTAGE));
+// Function to calculate battery percentage from the LiPo discharge curve
+int calculateBatteryPercentage() {
+  return (int)(batteryEstimator.getPercentage() + 0.5);
 }
 
 // Function to update battery status
 void updateBatteryStatus() {
   #if defined(ARDUINO_XIAO_ESP32S3)
+    batteryEstimator.update();
     batteryStatus.voltage = readBatteryVoltage();
-    batteryStatus.percentage = calculateBatteryPercentage(batteryStatus.voltage);
+    batteryStatus.percentage = calculateBatteryPercentage();
+    batteryStatus.minutesLeft = batteryEstimator.getTimeToEmptyMinutes();
     batteryStatus.isLow = batteryStatus.percentage < 20;  // Consider battery low below 20%
   #endif
 }
@@ -48,9 +44,10 @@ void updateBatteryStatus() {
 // Function to setup battery monitoring
 void setupBatteryMonitor() {
   #if defined(ARDUINO_XIAO_ESP32S3)
-    analogReadResolution(12);  // Set ADC resolution to 12 bits
-    analogSetAttenuation(ADC_11db);  // Set ADC attenuation for 0-3.3V range
+    batteryEstimator.begin(batteryPin, VOLTAGE_DIVIDER_RATIO, CHEMISTRY_LIPO, 1, BATTERY_CAPACITY_MAH);
+    batteryEstimator.setLoadCurrent(BATTERY_LOAD_CURRENT_MA);
+    updateBatteryStatus();
   #endif
 }
 
-#endif // BATTERY_MONITOR_H 
\ No newline at end of file
+#endif // BATTERY_MONITOR_H
@@ -0,0 +1,141 @@
+#ifndef BUTTON_CAPTURE_H
+#define BUTTON_CAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Interrupt-driven button capture.
+// The GPIO interrupt timestamps every edge with micros() into a single-producer/
+// single-consumer ring buffer; nextChange() drains it from loop() and debounces, so
+// a long stall in loop() delays a press but never loses it.
+class ButtonCapture {
+private:
+    struct Edge {
+        uint32_t timestampUs;
+        uint8_t level;
+    };
+
+    static const uint8_t QUEUE_SIZE = 32;  // Must be a power of two
+    static const uint8_t QUEUE_MASK = QUEUE_SIZE - 1;
+
+    Edge queue[QUEUE_SIZE];
+    std::atomic<uint8_t> head;   // Written by the ISR only
+    std::atomic<uint8_t> tail;   // Written by nextChange() only
+    volatile uint32_t droppedEdges;
+
+    uint8_t pin;
+    bool activeHigh;
+    uint32_t debounceUs;
+    bool attached;
+
+    bool stableLevel;        // Last debounced level
+    bool burstActive;        // An edge burst is waiting to settle
+    uint32_t burstStartUs;   // First edge of the burst
+    uint32_t burstLastUs;    // Most recent edge of the burst
+    bool burstLevel;         // Level after the most recent edge
+
+    static void IRAM_ATTR handleInterrupt(void* arg) {
+        ButtonCapture* self = static_cast<ButtonCapture*>(arg);
+        uint8_t h = self->head.load(std::memory_order_relaxed);
+        uint8_t next = (h + 1) & QUEUE_MASK;
+
+        if (next == self->tail.load(std::memory_order_acquire)) {
+            self->droppedEdges = self->droppedEdges + 1;
+            return;
+        }
+
+        self->queue[h].timestampUs = micros();
+        self->queue[h].level = digitalRead(self->pin);
+        self->head.store(next, std::memory_order_release);
+    }
+
+    // Returns true if the settled burst changed the debounced level
+    bool settleBurst(bool level) {
+        burstActive = false;
+        if (level == stableLevel) {
+            return false;
+        }
+        stableLevel = level;
+        return true;
+    }
+
+public:
+    ButtonCapture() : head(0), tail(0), droppedEdges(0), pin(0), activeHigh(true),
+                      debounceUs(50000), attached(false), stableLevel(false),
+                      burstActive(false), burstStartUs(0), burstLastUs(0),
+                      burstLevel(false) {}
+
+    // Pin mode must already be configured
+    void begin(uint8_t inputPin, bool pressedLevel, uint32_t debounceMicros) {
+        pin = inputPin;
+        activeHigh = pressedLevel;
+        debounceUs = debounceMicros;
+        stableLevel = digitalRead(pin);
+        burstActive = false;
+        head.store(0);
+        tail.store(0);
+        attachInterruptArg(digitalPinToInterrupt(pin), handleInterrupt, this, CHANGE);
+        attached = true;
+    }
+
+    void end() {
+        if (!attached) return;
+        detachInterrupt(digitalPinToInterrupt(pin));
+        attached = false;
+    }
+
+    // Get the next debounced change, call from loop() until it returns false.
+    // timestampUs is the micros() time of the first edge of the change.
+    bool nextChange(bool& pressed, uint32_t& timestampUs) {
+        if (!attached) return false;
+
+        uint8_t t = tail.load(std::memory_order_relaxed);
+        uint8_t h = head.load(std::memory_order_acquire);
+
+        while (t != h) {
+            Edge edge = queue[t];
+
+            // A quiet gap longer than the debounce time ends the previous burst
+            if (burstActive && (edge.timestampUs - burstLastUs) >= debounceUs) {
+                uint32_t startUs = burstStartUs;
+                if (settleBurst(burstLevel)) {
+                    // Leave this edge queued, it starts the next burst
+                    pressed = stableLevel == activeHigh;
+                    timestampUs = startUs;
+                    return true;
+                }
+            }
+
+            t = (t + 1) & QUEUE_MASK;
+            tail.store(t, std::memory_order_release);
+
+            if (!burstActive) {
+                burstActive = true;
+                burstStartUs = edge.timestampUs;
+            }
+            burstLastUs = edge.timestampUs;
+            burstLevel = edge.level;
+        }
+
+        // The last burst settles once the pin has been quiet long enough;
+        // the pin itself is the most reliable final level
+        if (burstActive && (micros() - burstLastUs) >= debounceUs) {
+            if (settleBurst(digitalRead(pin))) {
+                pressed = stableLevel == activeHigh;
+                timestampUs = burstStartUs;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isPressed() {
+        return stableLevel == activeHigh;
+    }
+
+    uint32_t getDroppedEdges() {
+        return droppedEdges;
+    }
+};
+
+#endif // BUTTON_CAPTURE_H
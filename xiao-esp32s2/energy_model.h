@@ -0,0 +1,228 @@
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Adafruit_NeoPixel.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include "pin_definitions.h"
+#include "battery_monitor.h"
+
+// On-device energy model.
+// Time is booked to one power state at a time (what the CPU and radio are doing),
+// plus the NeoPixel load and radio transmit bursts on top. Each state has a
+// calibrated current, so time becomes charge (mAh); dividing by total time gives the
+// average current and the projected runtime. The account lives in RTC memory, so it
+// covers deep sleep too, and starts over when the battery is connected.
+// Calibrate the currents below by measuring the board in each state; two builds can
+// then be compared by their predicted battery life.
+
+// Power states that exclude each other
+enum EnergyState : uint8_t {
+  ENERGY_ACTIVE = 0,      // CPU running, radio off
+  ENERGY_RADIO_RX,        // Radio on and listening (connecting, scanning, no power save)
+  ENERGY_MODEM_SLEEP,     // Connected with WiFi power save (radio sleeps between beacons)
+  ENERGY_LIGHT_SLEEP,
+  ENERGY_DEEP_SLEEP,
+  ENERGY_STATE_COUNT
+};
+
+// Loads on top of the state
+enum EnergyLoad : uint8_t {
+  ENERGY_LOAD_TX = 0,     // Radio transmit bursts
+  ENERGY_LOAD_LED,        // NeoPixels
+  ENERGY_LOAD_COUNT
+};
+
+// Calibrated currents in microamps (ESP32-S2 datasheet values plus board overhead)
+const uint32_t ENERGY_STATE_UA[ENERGY_STATE_COUNT] = {
+  27000,    // ENERGY_ACTIVE, 240 MHz
+  68000,    // ENERGY_RADIO_RX
+  22000,    // ENERGY_MODEM_SLEEP, average with DTIM 1
+  800,      // ENERGY_LIGHT_SLEEP
+  60        // ENERGY_DEEP_SLEEP, including the battery divider
+};
+const uint32_t ENERGY_TX_EXTRA_UA = 120000;        // TX current above RX
+const uint32_t ENERGY_TX_US_PER_PACKET = 600;      // Preamble, ACK and TCP overhead per packet
+const uint32_t ENERGY_TX_BITS_PER_US = 20;         // Effective PHY rate (20 Mbit/s)
+const uint32_t ENERGY_LED_CHANNEL_UA = 20000;      // One NeoPixel channel at 255
+const uint32_t ENERGY_LED_IDLE_UA = 1000;          // NeoPixel quiescent current per pixel
+const uint32_t ENERGY_ACCOUNT_MAGIC = 0x454E5247;  // "ENRG"
+
+// Charge is kept in microamp-milliseconds (TX bursts are charge only, loadMs stays 0); uint64 covers years at any state current
+struct EnergyAccount {
+  uint32_t magic;
+  uint64_t stateMs[ENERGY_STATE_COUNT];
+  uint64_t stateCharge[ENERGY_STATE_COUNT];
+  uint64_t loadMs[ENERGY_LOAD_COUNT];
+  uint64_t loadCharge[ENERGY_LOAD_COUNT];
+  uint32_t txPackets;
+  uint32_t boots;
+  int64_t sleepStartMs;   // RTC clock at the start of deep sleep, 0 if awake
+};
+
+RTC_DATA_ATTR EnergyAccount energyAccount;
+
+extern Adafruit_NeoPixel pixels;
+
+// RTC clock in milliseconds, continues through deep sleep (event_batch.h)
+int64_t rtcNowMs();
+
+EnergyState energyState = ENERGY_ACTIVE;
+int64_t energyLastUpdateUs = 0;
+uint32_t energyLedUa = 0;   // NeoPixel current at the last update
+
+const char* getEnergyStateName(uint8_t state) {
+  switch (state) {
+    case ENERGY_ACTIVE: return "active";
+    case ENERGY_RADIO_RX: return "radio_rx";
+    case ENERGY_MODEM_SLEEP: return "modem_sleep";
+    case ENERGY_LIGHT_SLEEP: return "light_sleep";
+    case ENERGY_DEEP_SLEEP: return "deep_sleep";
+    default: return "unknown";
+  }
+}
+
+void bookEnergyState(EnergyState state, uint64_t ms) {
+  energyAccount.stateMs[state] += ms;
+  energyAccount.stateCharge[state] += ms * ENERGY_STATE_UA[state];
+}
+
+void bookEnergyLoad(EnergyLoad load, uint64_t ms, uint32_t microamps) {
+  energyAccount.loadMs[load] += ms;
+  energyAccount.loadCharge[load] += ms * microamps;
+}
+
+// Function to estimate the current NeoPixel draw from the pixel buffer
+// (the buffer already has the global brightness applied)
+uint32_t readLedCurrentUa() {
+  const uint8_t* data = pixels.getPixels();
+  uint32_t sum = 0;
+  for (int i = 0; i < numPixels * 3; i++) {
+    sum += data[i];
+  }
+  return sum == 0 ? 0 : sum * ENERGY_LED_CHANNEL_UA / 255 + numPixels * ENERGY_LED_IDLE_UA;
+}
+
+// Function to classify what the CPU and radio are doing now
+EnergyState observeEnergyState() {
+  if (WiFi.getMode() == WIFI_OFF) return ENERGY_ACTIVE;
+  if (WiFi.status() == WL_CONNECTED && WiFi.getSleep()) return ENERGY_MODEM_SLEEP;
+  return ENERGY_RADIO_RX;
+}
+
+// Function to book the time since the last update to the state and loads seen then,
+// and observe the current ones; call from loop()
+void updateEnergyModel() {
+  int64_t now = esp_timer_get_time();
+  uint64_t ms = (now - energyLastUpdateUs) / 1000;
+  if (ms == 0) return;
+  energyLastUpdateUs += ms * 1000;
+
+  bookEnergyState(energyState, ms);
+  if (energyLedUa > 0) {
+    bookEnergyLoad(ENERGY_LOAD_LED, ms, energyLedUa);
+  }
+
+  energyState = observeEnergyState();
+  energyLedUa = readLedCurrentUa();
+}
+
+// Function to book one transmitted MQTT message of length bytes
+void recordEnergyTx(size_t length) {
+  // Headers (MQTT, TCP/IP, 802.11) add roughly 100 bytes
+  uint32_t airtimeUs = ENERGY_TX_US_PER_PACKET + (length + 100) * 8 / ENERGY_TX_BITS_PER_US;
+  energyAccount.txPackets++;
+  energyAccount.loadCharge[ENERGY_LOAD_TX] += (uint64_t)airtimeUs * ENERGY_TX_EXTRA_UA / 1000;
+}
+
+// Function to start the model; books the deep sleep that just ended, if any
+void setupEnergyModel() {
+  if (energyAccount.magic != ENERGY_ACCOUNT_MAGIC) {
+    memset(&energyAccount, 0, sizeof(energyAccount));
+    energyAccount.magic = ENERGY_ACCOUNT_MAGIC;
+  }
+  if (energyAccount.sleepStartMs != 0) {
+    int64_t slept = rtcNowMs() - energyAccount.sleepStartMs;
+    if (slept > 0) {
+      bookEnergyState(ENERGY_DEEP_SLEEP, slept);
+    }
+    energyAccount.sleepStartMs = 0;
+  }
+  energyAccount.boots++;
+
+  // Time from reset to here ran with the CPU active
+  energyLastUpdateUs = 0;
+  energyState = ENERGY_ACTIVE;
+  updateEnergyModel();
+}
+
+// Function to close the books before deep sleep
+void energyBeforeDeepSleep() {
+  updateEnergyModel();
+  energyAccount.sleepStartMs = rtcNowMs();
+}
+
+// Totals
+uint64_t getEnergyTotalMs() {
+  uint64_t total = 0;
+  for (int i = 0; i < ENERGY_STATE_COUNT; i++) total += energyAccount.stateMs[i];
+  return total;
+}
+
+uint64_t getEnergyTotalCharge() {
+  uint64_t total = 0;
+  for (int i = 0; i < ENERGY_STATE_COUNT; i++) total += energyAccount.stateCharge[i];
+  for (int i = 0; i < ENERGY_LOAD_COUNT; i++) total += energyAccount.loadCharge[i];
+  return total;
+}
+
+// Charge in microamp-milliseconds to mAh
+float chargeToMah(uint64_t charge) {
+  return charge / 3600000000.0;
+}
+
+// Average current in mA over the whole account
+float getAverageCurrentMa() {
+  uint64_t ms = getEnergyTotalMs();
+  return ms == 0 ? 0.0 : (float)getEnergyTotalCharge() / ms / 1000.0;
+}
+
+// Projected hours on a full battery at the average current
+float getPredictedLifeHours() {
+  float average = getAverageCurrentMa();
+  return average > 0.0 ? BATTERY_CAPACITY_MAH / average : 0.0;
+}
+
+// Projected hours left from the current battery percentage, -1 if unknown
+float getPredictedRuntimeHours() {
+  float average = getAverageCurrentMa();
+  if (average <= 0.0 || batteryPin == -1 || batteryStatus.voltage == 0.0) return -1.0;
+  return batteryStatus.percentage / 100.0 * BATTERY_CAPACITY_MAH / average;
+}
+
+// Function to write the account as JSON, returns the length
+int formatEnergyJson(char* buffer, size_t size) {
+  int length = snprintf(buffer, size, "{\"build\":\"%s %s\",\"boots\":%lu,\"states\":{",
+                        __DATE__, __TIME__, (unsigned long)energyAccount.boots);
+  for (int i = 0; i < ENERGY_STATE_COUNT && length < (int)size; i++) {
+    length += snprintf(buffer + length, size - length, "%s\"%s\":{\"s\":%lu,\"mAh\":%.3f}",
+                       i > 0 ? "," : "", getEnergyStateName(i),
+                       (unsigned long)(energyAccount.stateMs[i] / 1000),
+                       chargeToMah(energyAccount.stateCharge[i]));
+  }
+  if (length < (int)size) {
+    length += snprintf(buffer + length, size - length,
+                       "},\"tx\":{\"packets\":%lu,\"mAh\":%.3f},\"led\":{\"s\":%lu,\"mAh\":%.3f},"
+                       "\"totalMah\":%.3f,\"averageMa\":%.3f,\"lifeHours\":%.1f,\"runtimeHours\":%.1f}",
+                       (unsigned long)energyAccount.txPackets, chargeToMah(energyAccount.loadCharge[ENERGY_LOAD_TX]),
+                       (unsigned long)(energyAccount.loadMs[ENERGY_LOAD_LED] / 1000),
+                       chargeToMah(energyAccount.loadCharge[ENERGY_LOAD_LED]),
+                       chargeToMah(getEnergyTotalCharge()), getAverageCurrentMa(),
+                       getPredictedLifeHours(), getPredictedRuntimeHours());
+  }
+  return length;
+}
+
+#endif // ENERGY_MODEL_H
@@ -0,0 +1,141 @@
+#ifndef EVENT_BATCH_H
+#define EVENT_BATCH_H
+
+#include <Arduino.h>
+#include <sys/time.h>
+#include <esp_sleep.h>
+#include "config_local.h"
+#include "event_history.h"
+#include "mqtt_handler.h"
+
+// Radio-off event batching.
+// Presses that wake the board from deep sleep are timestamped into a ring buffer in
+// RTC memory and the board sleeps again without turning the radio on. The batch is
+// sent in one connect/publish cycle when it reaches BATCH_FLUSH_COUNT events, when its
+// oldest event is BATCH_MAX_LATENCY_MS old (a timer wake is armed for that deadline),
+// or straight away for a priority event (a press held for BATCH_PRIORITY_HOLD_MS).
+// Timestamps come from the RTC-backed system clock, which keeps running in deep sleep.
+//
+// Batch message on <topic_publish>/batch:
+//   {"events":[[<msAgo>,<type>,<heldMs>],...],"dropped":<n>}
+// msAgo is relative to the publish, so no wall-clock time is needed on the device.
+
+const bool ENABLE_EVENT_BATCHING = true;
+const uint8_t BATCH_CAPACITY = 32;                   // Events kept in RTC memory
+const uint8_t BATCH_FLUSH_COUNT = 16;                // Send once this many are waiting
+const uint32_t BATCH_MAX_LATENCY_MS = 600000;        // Oldest event is sent within 10 minutes
+const uint32_t BATCH_PRIORITY_HOLD_MS = 1000;        // Longer presses are sent at once
+const uint32_t EVENT_BATCH_MAGIC = 0x42415443;       // "BATC"
+const uint16_t BATCH_MQTT_BUFFER = 768;
+
+// One batched event (16 bytes: 12 of data, padded to the 8-byte alignment of timeMs)
+struct BatchedEvent {
+  int64_t timeMs;     // RTC clock time of the event
+  uint8_t type;       // EventType
+  uint8_t reserved;
+  uint16_t heldMs;    // Press duration
+};
+
+struct EventBatch {
+  uint32_t magic;
+  uint8_t head;       // Next slot to write
+  uint8_t count;
+  bool priority;      // A priority event is waiting
+  uint16_t dropped;   // Events overwritten because the batch could not be sent
+  BatchedEvent events[BATCH_CAPACITY];
+};
+
+RTC_DATA_ATTR EventBatch eventBatch;
+
+// Function to get the RTC clock in milliseconds, continues through deep sleep
+int64_t rtcNowMs() {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  return (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
+// Function to set up the batch, keeping events from before the last deep sleep
+void setupEventBatch() {
+  if (eventBatch.magic != EVENT_BATCH_MAGIC) {
+    memset(&eventBatch, 0, sizeof(eventBatch));
+    eventBatch.magic = EVENT_BATCH_MAGIC;
+  }
+  // Default PubSubClient buffer (256 bytes) is too small for a full batch
+  client.setBufferSize(BATCH_MQTT_BUFFER);
+}
+
+bool hasBatchedEvents() {
+  return eventBatch.count > 0;
+}
+
+// Function to add an event to the batch, overwriting the oldest if it is full
+void batchEvent(EventType type, uint16_t heldMs, bool priority) {
+  BatchedEvent& event = eventBatch.events[eventBatch.head];
+  event.timeMs = rtcNowMs();
+  event.type = type;
+  event.reserved = 0;
+  event.heldMs = heldMs;
+
+  eventBatch.head = (eventBatch.head + 1) % BATCH_CAPACITY;
+  if (eventBatch.count < BATCH_CAPACITY) {
+    eventBatch.count++;
+  } else {
+    eventBatch.dropped++;
+  }
+  eventBatch.priority = eventBatch.priority || priority;
+}
+
+const BatchedEvent& getBatchedEvent(uint8_t index) {
+  uint8_t oldest = (eventBatch.head + BATCH_CAPACITY - eventBatch.count) % BATCH_CAPACITY;
+  return eventBatch.events[(oldest + index) % BATCH_CAPACITY];
+}
+
+// Milliseconds until the oldest event reaches the latency bound (0 if overdue)
+uint32_t batchTimeToDeadline() {
+  int64_t age = rtcNowMs() - getBatchedEvent(0).timeMs;
+  return age >= BATCH_MAX_LATENCY_MS ? 0 : BATCH_MAX_LATENCY_MS - age;
+}
+
+// True if the batch should be sent now
+bool isBatchFlushDue() {
+  if (!hasBatchedEvents()) return false;
+  return eventBatch.priority || eventBatch.count >= BATCH_FLUSH_COUNT || batchTimeToDeadline() == 0;
+}
+
+// Function to publish the whole batch in one message and empty it, needs MQTT connected
+bool publishBatch() {
+  char topic[64];
+  snprintf(topic, sizeof(topic), "%s/batch", topic_publish);
+
+  char message[BATCH_MQTT_BUFFER - 96];
+  int64_t now = rtcNowMs();
+  size_t length = snprintf(message, sizeof(message), "{\"events\":[");
+  for (uint8_t i = 0; i < eventBatch.count && length < sizeof(message); i++) {
+    const BatchedEvent& event = getBatchedEvent(i);
+    length += snprintf(message + length, sizeof(message) - length, "%s[%lu,%u,%u]",
+                       i > 0 ? "," : "", (unsigned long)(now - event.timeMs), event.type, event.heldMs);
+  }
+  if (length < sizeof(message)) {
+    length += snprintf(message + length, sizeof(message) - length, "],\"dropped\":%u}", eventBatch.dropped);
+  }
+  if (length >= sizeof(message) || !client.publish(topic, message)) {
+    Serial.println("Event batch: publish failed, keeping the events");
+    return false;
+  }
+  recordEnergyTx(strlen(topic) + length);
+
+  Serial.printf("Event batch: sent %u events\n", eventBatch.count);
+  eventBatch.count = 0;
+  eventBatch.dropped = 0;
+  eventBatch.priority = false;
+  return true;
+}
+
+// Function to arm a timer wake for the batch latency bound, call before deep sleep
+void armBatchTimer() {
+  if (hasBatchedEvents()) {
+    esp_sleep_enable_timer_wakeup((uint64_t)batchTimeToDeadline() * 1000 + 1000);
+  }
+}
+
+#endif // EVENT_BATCH_H
@@ -0,0 +1,172 @@
+#ifndef FAST_WAKE_H
+#define FAST_WAKE_H
+
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/rtc_io.h>
+#include "config_local.h"
+#include "mqtt_handler.h"
+
+// Fast path for a button wake from deep sleep.
+// Before sleeping, the network state of the working connection (access point, channel,
+// BSSID, DHCP lease, broker) is kept in RTC memory, which survives deep sleep. When the
+// button wakes the board, setup() calls fastWakePublish() first: it joins the known
+// access point with the cached static configuration (no scan, no DHCP), publishes the
+// press, and the board goes straight back to sleep - no web server, mDNS or history.
+// If anything fails the cache is dropped and the normal setup() runs.
+
+const uint32_t WAKE_CACHE_MAGIC = 0x57414B45;       // "WAKE"
+const unsigned long FAST_WAKE_WIFI_TIMEOUT = 3000;  // Give up on the cached AP after 3 s
+const uint16_t FAST_WAKE_SOCKET_TIMEOUT = 2;        // Seconds for the MQTT connect
+const uint16_t FAST_WAKE_MAX_REUSE = 50;            // Full boot after this many fast wakes, renews the lease
+const unsigned long FAST_WAKE_RELEASE_TIMEOUT = 2000;
+
+// Network state kept across deep sleep
+struct WakeCache {
+  uint32_t magic;
+  uint8_t credential;   // Index into wifiCredentials
+  uint8_t bssid[6];
+  int32_t channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  bool altServer;       // Broker was mqtt_server_alt
+  uint16_t fastWakes;   // Fast wakes since the cache was written
+};
+
+RTC_DATA_ATTR WakeCache wakeCache;
+
+// True if the board was woken from deep sleep by the button
+bool isButtonWake() {
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT0;
+}
+
+// Function to arm the button (active HIGH, pulled down) as the deep sleep wake source.
+// Uses ext0, which keeps the pin biased through the RTC domain; returns false if the
+// pin is not an RTC GPIO and cannot wake the board.
+bool armButtonWake(int pin) {
+  if (!esp_sleep_is_valid_wakeup_gpio((gpio_num_t)pin)) {
+    return false;
+  }
+  rtc_gpio_pullup_dis((gpio_num_t)pin);
+  rtc_gpio_pulldown_en((gpio_num_t)pin);
+  esp_sleep_enable_ext0_wakeup((gpio_num_t)pin, HIGH);
+  return true;
+}
+
+// Function to hand the button pin back to the digital GPIO matrix after an ext0 wake,
+// call before pinMode()/digitalRead()
+void releaseButtonWakePin(int pin) {
+  if (isButtonWake()) {
+    rtc_gpio_deinit((gpio_num_t)pin);
+  }
+}
+
+// Function to keep the current connection in RTC memory, call before deep sleep
+void saveWakeCache() {
+  if (WiFi.status() != WL_CONNECTED) return;
+
+  String ssid = WiFi.SSID();
+  for (int i = 0; i < wifiCredentialsCount; i++) {
+    if (ssid == wifiCredentials[i].ssid) {
+      wakeCache.credential = i;
+      memcpy(wakeCache.bssid, WiFi.BSSID(), sizeof(wakeCache.bssid));
+      wakeCache.channel = WiFi.channel();
+      wakeCache.ip = WiFi.localIP();
+      wakeCache.gateway = WiFi.gatewayIP();
+      wakeCache.subnet = WiFi.subnetMask();
+      wakeCache.dns = WiFi.dnsIP();
+      wakeCache.altServer = usingAltServer;
+      wakeCache.fastWakes = 0;
+      wakeCache.magic = WAKE_CACHE_MAGIC;
+      return;
+    }
+  }
+}
+
+// Function to drop the cached network state
+void clearWakeCache() {
+  wakeCache.magic = 0;
+}
+
+// Function to connect WiFi and MQTT using the cached network state,
+// returns false (dropping the cache) if either fails
+bool fastWakeConnect() {
+  if (wakeCache.magic != WAKE_CACHE_MAGIC || wakeCache.fastWakes >= FAST_WAKE_MAX_REUSE) {
+    return false;
+  }
+
+  // Join the cached access point directly: no scan, no DHCP
+  WiFi.mode(WIFI_STA);
+  WiFi.config(IPAddress(wakeCache.ip), IPAddress(wakeCache.gateway),
+              IPAddress(wakeCache.subnet), IPAddress(wakeCache.dns));
+  const WiFiCredential& credential = wifiCredentials[wakeCache.credential];
+  WiFi.begin(credential.ssid, credential.password, wakeCache.channel, wakeCache.bssid, true);
+  updateEnergyModel();  // Book the time until now as CPU only, the radio is on from here
+
+  unsigned long wifiStart = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - wifiStart > FAST_WAKE_WIFI_TIMEOUT) {
+      Serial.println("Fast wake: cached access point not reachable, doing a full setup");
+      clearWakeCache();
+      WiFi.disconnect(true);
+      return false;
+    }
+    delay(5);
+  }
+  Serial.printf("Fast wake: WiFi ready after %lu ms\n", (unsigned long)(esp_timer_get_time() / 1000));
+
+  usingAltServer = wakeCache.altServer;
+  client.setServer(usingAltServer ? mqtt_server_alt : mqtt_server, mqtt_port);
+  client.setSocketTimeout(FAST_WAKE_SOCKET_TIMEOUT);
+  if (!client.connect(getClientId().c_str())) {
+    Serial.println("Fast wake: MQTT connect failed, doing a full setup");
+    clearWakeCache();
+    return false;
+  }
+  return true;
+}
+
+// Function to flush pending publishes and disconnect before the radio goes down
+void fastWakeDisconnect() {
+  client.loop();
+  client.disconnect();
+  wakeCache.fastWakes++;
+}
+
+// Function to publish a button wake using the cached network state.
+// Returns true if the press was published; the caller then goes back to sleep.
+bool fastWakePublish() {
+  if (!isButtonWake()) return false;
+  Serial.println("Button wake: trying the fast path");
+
+  if (!fastWakeConnect()) return false;
+  if (!client.publish(topic_publish, "PRESSED")) {
+    Serial.println("Fast wake: MQTT publish failed, doing a full setup");
+    clearWakeCache();
+    client.disconnect();
+    return false;
+  }
+  recordEnergyTx(strlen(topic_publish) + strlen("PRESSED"));
+  int64_t publishedUs = esp_timer_get_time();
+  fastWakeDisconnect();
+
+  // Time since the application started; the ROM and bootloader add a few ms more
+  Serial.printf("Fast wake: published in %lu ms (fast wake %u)\n",
+                (unsigned long)(publishedUs / 1000), wakeCache.fastWakes);
+  return true;
+}
+
+// Function to wait (bounded) for the button to be released, so a held button does
+// not wake the board again straight away; returns how long it was held in ms
+unsigned long waitForButtonRelease(int pin) {
+  unsigned long start = millis();
+  while (digitalRead(pin) == HIGH && millis() - start < FAST_WAKE_RELEASE_TIMEOUT) {
+    delay(10);
+  }
+  return millis() - start;
+}
+
+#endif // FAST_WAKE_H
@@ -5,6 +5,8 @@
 #include "wifi_setup.h"
 #include "pin_definitions.h"
 #include "config_local.h"
+#include "event_history.h"
+#include "energy_model.h"
 #include <esp_system.h>  // Required for esp_read_efuse_mac
 
 // Function to get unique client ID based on MAC address
@@ -19,6 +21,9 @@ String getClientId() {
 WiFiClient espClient;
 PubSubClient client(espClient);
 
+// Broker in use, remembered so a fast wake (fast_wake.h) goes straight to it
+bool usingAltServer = false;
+
 // Forward declaration of the NeoPixel object
 extern Adafruit_NeoPixel pixels;
 
@@ -57,7 +62,6 @@ void reconnectMQTT() {
     return;
   }
 
-  static bool usingAltServer = false;
   const char* currentServer = usingAltServer ? mqtt_server_alt : mqtt_server;
 
   // Loop until we're reconnected
@@ -73,6 +77,7 @@ void reconnectMQTT() {
     // Attempt to connect without authentication
     if (client.connect(clientId.c_str())) {
       Serial.println("connected");
+      recordEvent(EVENT_MQTT_CONNECTED);
       Serial.print("Client ID: ");
       Serial.println(clientId);
       
@@ -117,6 +122,9 @@ void setupMQTT() {
 // Function to maintain MQTT connection and handle messages
 void mqttLoop() {
   if (!client.connected()) {
+    if (client.state() == MQTT_CONNECTION_LOST) {
+      recordEvent(EVENT_MQTT_DISCONNECTED);
+    }
     reconnectMQTT();
   }
   client.loop();
@@ -125,8 +133,23 @@ void mqttLoop() {
 // Function to publish a message
 void publishMessage(const char* message) {
   if (client.connected()) {
-    client.publish(topic_publish, message);
+    if (client.publish(topic_publish, message)) {
+      recordEnergyTx(strlen(topic_publish) + strlen(message));
+    }
+  }
+}
+
+// Function to publish the energy account on <topic_publish>/energy
+bool publishEnergyReport() {
+  char topic[64];
+  snprintf(topic, sizeof(topic), "%s/energy", topic_publish);
+  char report[448];
+  int length = formatEnergyJson(report, sizeof(report));
+  if (length >= (int)sizeof(report) || !client.publish(topic, report)) {
+    return false;
   }
+  recordEnergyTx(strlen(topic) + length);
+  return true;
 }
 
 #endif // MQTT_HANDLER_H 
\ No newline at end of file
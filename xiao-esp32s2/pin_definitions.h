@@ -17,7 +17,7 @@
 //   #define batteryPin -1  // No ADC on ESP32C3
 // #elif defined(ARDUINO_BOARD) && (ARDUINO_BOARD == "ESP32S2_DEV" || ARDUINO_BOARD == "esp32s3")
   #define BOARD_TYPE "ESP32S2_DEV"
-  #define buttonPin 39
+  #define buttonPin 4     // Must be an RTC GPIO (0-21 on S2/S3) to wake from deep sleep
   #define ledPin -1     // No LED on ESP32S3
   #define neoPixelPin 40
   #define batteryPin 2  // ADC1_2 on ESP32S3
@@ -31,7 +31,7 @@ const int brightness = 50;
 
 // Battery monitoring configuration
 const float VOLTAGE_DIVIDER_RATIO = 2.0;  // 2x voltage divider (2x 10k resistors)
-const float MAX_BATTERY_VOLTAGE = 4.2;    // Maximum battery voltage
-const float MIN_BATTERY_VOLTAGE = 3.3;    // Minimum battery voltage
+const float BATTERY_CAPACITY_MAH = 500.0; // Single cell LiPo capacity
+const float BATTERY_LOAD_CURRENT_MA = 90.0; // Typical draw with WiFi connected
 
 #endif // PIN_DEFINITIONS_H 
\ No newline at end of file
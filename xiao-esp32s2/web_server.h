@@ -4,6 +4,8 @@
 #include <WebServer.h>
 #include <ESPmDNS.h>
 #include "config_local.h"
+#include "event_history.h"
+#include "energy_model.h"
 
 // Create web server instance
 WebServer server(80);
@@ -62,6 +64,52 @@ void handleRoot() {
   server.send(200, "text/html", html);
 }
 
+// Function to handle history export - streams the event history in chunks
+// /history (CSV) or /history?format=bin (packed HistoryEvent records)
+void handleHistory() {
+  bool binary = server.arg("format") == "bin";
+  char chunk[512];
+  size_t used = 0;
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, binary ? "application/octet-stream" : "text/csv", "");
+
+  if (!binary) {
+    used = snprintf(chunk, sizeof(chunk), "sequence,boot,timestamp_ms,event,source\n");
+  }
+
+  for (uint16_t i = 0; i < historyCount; i++) {
+    const HistoryEvent& event = getHistoryEvent(i);
+    size_t length = binary ? sizeof(HistoryEvent) : 64;
+
+    // Flush the chunk when the next record might not fit
+    if (used + length > sizeof(chunk)) {
+      server.sendContent(chunk, used);
+      used = 0;
+    }
+
+    if (binary) {
+      memcpy(chunk + used, &event, sizeof(HistoryEvent));
+      used += sizeof(HistoryEvent);
+    } else {
+      used += formatHistoryCsvLine(event, chunk + used, sizeof(chunk) - used);
+    }
+  }
+
+  if (used > 0) {
+    server.sendContent(chunk, used);
+  }
+  server.sendContent("");  // Terminate the chunked response
+}
+
+// Function to handle the energy account - time and charge per power state as JSON
+void handleEnergy() {
+  updateEnergyModel();
+  char json[448];
+  formatEnergyJson(json, sizeof(json));
+  server.send(200, "application/json", json);
+}
+
 // Function to setup web server
 void setupWebServer() {
   // Set up mDNS
@@ -72,6 +120,8 @@ void setupWebServer() {
   
   // Set up web server routes
   server.on("/", handleRoot);
+  server.on("/history", handleHistory);
+  server.on("/energy", handleEnergy);
   
   // Start web server
   server.begin();
@@ -84,9 +134,10 @@ void handleWebServer() {
 }
 
 // Function to update button press information
-void updateButtonPress(bool isPressed) {
-  lastButtonPress.timestamp = millis();
+void updateButtonPress(bool isPressed, unsigned long timestamp) {
+  lastButtonPress.timestamp = timestamp;
   lastButtonPress.isPressed = isPressed;
+  recordEvent(isPressed ? EVENT_BUTTON_PRESS : EVENT_BUTTON_RELEASE, 0, timestamp);
 }
 
 #endif // WEB_SERVER_H 
\ No newline at end of file
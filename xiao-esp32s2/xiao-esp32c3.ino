@@ -6,14 +6,17 @@
 #include "mqtt_handler.h"
 #include "web_server.h"
 #include "battery_monitor.h"
+#include "event_history.h"
+#include "button_capture.h"
+#include "fast_wake.h"
+#include "event_batch.h"
+#include "energy_model.h"
 
 // Create NeoPixel object
 Adafruit_NeoPixel pixels(numPixels, neoPixelPin, NEO_GRB + NEO_KHZ800);
 
-// Variable to store the button state
-int buttonState = 0;
-int lastButtonState = LOW;
-unsigned long lastDebounceTime = 0;
+// Button capture (interrupt-driven, debounced in loop)
+ButtonCapture buttonCapture;
 unsigned long debounceDelay = 50;  // Debounce time in milliseconds
 
 // Variable to track color state
@@ -29,14 +32,65 @@ const unsigned long SLEEP_TIMEOUT = 300000;  // 5 minutes in milliseconds
 unsigned long lastBatteryCheck = 0;
 const unsigned long BATTERY_CHECK_INTERVAL = 60000;  // Check battery every minute
 
+// Last known WiFi state for history logging
+bool lastWiFiConnected = false;
+
+// Variable to track last energy report time
+unsigned long lastEnergyReport = 0;
+const unsigned long ENERGY_REPORT_INTERVAL = 600000;  // Publish the energy account every 10 minutes
+
+// Button press that woke the board but could not be sent by the fast path
+bool wakePressPending = false;
+
+void startDeepSleep();
+
 void setup() {
   // Initialize serial communication at 115200 baud rate
   Serial.begin(115200);
   Serial.println("\n\n=== Xiao ESP32 Device Setup ===");
   
+  // Book the deep sleep that just ended and start timing this wake
+  setupEnergyModel();
+  
   // Initialize MQTT topics
   initMQTTTopics();
   
+  // Events batched in RTC memory while the radio was off
+  setupEventBatch();
+  
+  releaseButtonWakePin(buttonPin);
+  pinMode(buttonPin, INPUT_PULLDOWN);
+  if (ENABLE_EVENT_BATCHING) {
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    if (isButtonWake()) {
+      // Button wake: store the press, long presses are sent at once
+      unsigned long held = waitForButtonRelease(buttonPin);
+      batchEvent(EVENT_BUTTON_PRESS, held, held >= BATCH_PRIORITY_HOLD_MS);
+    }
+    if (isButtonWake() || cause == ESP_SLEEP_WAKEUP_TIMER) {
+      // Sleep again with the radio off until the batch is due
+      if (!isBatchFlushDue()) {
+        startDeepSleep();
+      }
+      // Send the batch in one connect/publish cycle
+      Serial.println("Event batch: flushing");
+      if (fastWakeConnect()) {
+        bool sent = publishBatch();
+        fastWakeDisconnect();
+        if (sent) {
+          startDeepSleep();
+        }
+      }
+      // Otherwise the full setup below connects and loop() sends the batch
+    }
+  } else if (fastWakePublish()) {
+    // Button wake: publish the press with the cached network state and sleep again
+    waitForButtonRelease(buttonPin);
+    startDeepSleep();
+  } else {
+    wakePressPending = isButtonWake();
+  }
+  
   // Print board information
   Serial.print("Board: ");
   Serial.println(BOARD_TYPE);
@@ -56,6 +110,7 @@ void setup() {
   
   // Set the button pin as input (using internal pull-down resistor)
   pinMode(buttonPin, INPUT_PULLDOWN);
+  buttonCapture.begin(buttonPin, HIGH, debounceDelay * 1000);
   Serial.println("Button pin set as INPUT_PULLDOWN");
   
   // Set the LED pin as output if available
@@ -76,6 +131,9 @@ void setup() {
     Serial.println("Battery monitoring initialized");
   }
   
+  // Initialize event history (restores events saved before the last sleep)
+  setupHistory();
+  
   // Print MAC address
   Serial.print("\nMAC Address: ");
   Serial.println(WiFi.macAddress());
@@ -115,19 +173,47 @@ void enterSleepMode() {
     digitalWrite(ledPin, LOW);
   }
   
+  // Persist event history before RAM is lost
+  saveHistory();
+  
+  // Keep the connection details for the fast wake path
+  saveWakeCache();
+  
+  startDeepSleep();
+  
+  // Only reached if the button cannot wake the board, try again after the timeout
+  lastActivityTime = millis();
+}
+
+// Function to turn the radio off and deep sleep until the button is pressed.
+// Returns without sleeping if the button pin cannot wake the board.
+void startDeepSleep() {
+  if (!esp_sleep_is_valid_wakeup_gpio((gpio_num_t)buttonPin)) {
+    Serial.printf("GPIO%d cannot wake from deep sleep, staying awake\n", buttonPin);
+    return;
+  }
+  
+  // Close the energy account, the RTC clock times the sleep
+  energyBeforeDeepSleep();
+  
   // Disconnect WiFi
   WiFi.disconnect(true);
   WiFi.mode(WIFI_OFF);
   
-  // Configure wake-up source (button)
-  gpio_wakeup_enable((gpio_num_t)buttonPin, GPIO_INTR_HIGH_LEVEL);
-  esp_sleep_enable_gpio_wakeup();
+  // Wake for the batch latency bound if events are waiting
+  armBatchTimer();
+  
+  // Configure wake-up source (button, ext0)
+  armButtonWake(buttonPin);
   
   // Enter deep sleep
   esp_deep_sleep_start();
 }
 
 void loop() {
+  // Book the time since the last loop to the current power state
+  updateEnergyModel();
+  
   // Check if it's time to enter sleep mode
   if (millis() - lastActivityTime > SLEEP_TIMEOUT) {
     enterSleepMode();
@@ -151,50 +237,66 @@ void loop() {
   // Check WiFi connection and reconnect if necessary
   reconnectWiFi();
   
+  // Record WiFi connection changes
+  bool wifiConnected = isWiFiConnected();
+  if (wifiConnected != lastWiFiConnected) {
+    lastWiFiConnected = wifiConnected;
+    recordEvent(wifiConnected ? EVENT_WIFI_CONNECTED : EVENT_WIFI_DISCONNECTED);
+  }
+  
   // Handle MQTT connection and messages
   mqttLoop();
+  
+  // Send the press that woke the board once the full setup has connected
+  if (wakePressPending && client.connected()) {
+    publishMessage("PRESSED");
+    wakePressPending = false;
+  }
+  
+  // Send batched events left over from a failed radio-off flush
+  if (hasBatchedEvents() && client.connected()) {
+    static unsigned long lastBatchAttempt = 0;
+    if (millis() - lastBatchAttempt >= 5000) {
+      lastBatchAttempt = millis();
+      publishBatch();
+    }
+  }
+
+  // Publish the energy account with the other telemetry
+  if (client.connected() && millis() - lastEnergyReport >= ENERGY_REPORT_INTERVAL) {
+    lastEnergyReport = millis();
+    publishEnergyReport();
+  }
 
   // Handle web server
   handleWebServer();
+  
+  // Persist event history periodically
+  historyLoop();
 
-  // Read the state of the button
-  int reading = digitalRead(buttonPin);
-
-  // Check if the button state has changed
-  if (reading != lastButtonState) {
-    lastDebounceTime = millis();
-  }
-
-  // If the button state has been stable for longer than the debounce delay
-  if ((millis() - lastDebounceTime) > debounceDelay) {
-    // If the button state has changed
-    if (reading != buttonState) {
-      buttonState = reading;
-
-      // If the button is pressed (HIGH with pull-down)
-      if (buttonState == HIGH) {
-        Serial.println("Button pressed!");
-        // Publish button press event
-        publishMessage("PRESSED");
-        // Update button press information for web server
-        updateButtonPress(true);
-        // Update last activity time
-        lastActivityTime = millis();
-      } else {
-        Serial.println("Button released!");
-        // Publish button release event
-        publishMessage("RELEASED");
-        // Update button press information for web server
-        updateButtonPress(false);
-        // Update last activity time
-        lastActivityTime = millis();
-      }
+  // Handle every debounced button change captured since the last loop
+  bool pressed;
+  uint32_t pressMicros;
+  while (buttonCapture.nextChange(pressed, pressMicros)) {
+    // Convert the captured press time to the millis() timebase
+    unsigned long pressMillis = millis() - (micros() - pressMicros) / 1000;
+    
+    // If the button is pressed (HIGH with pull-down)
+    if (pressed) {
+      Serial.println("Button pressed!");
+      // Publish button press event
+      publishMessage("PRESSED");
+    } else {
+      Serial.println("Button released!");
+      // Publish button release event
+      publishMessage("RELEASED");
     }
+    // Update button press information for web server
+    updateButtonPress(pressed, pressMillis);
+    // Update last activity time
+    lastActivityTime = millis();
   }
 
-  // Save the reading for next time
-  lastButtonState = reading;
-
   // Check if it's time to change the NeoPixel color
   if (millis() - lastColorChange >= 2000) {  // 2000ms = 2 seconds
     lastColorChange = millis();
@@ -218,7 +320,5 @@ void loop() {
       }
       pixels.show();  // Update the NeoPixel
     }
-    // Update last activity time
-    lastActivityTime = millis();
   }
 }
\ No newline at end of file
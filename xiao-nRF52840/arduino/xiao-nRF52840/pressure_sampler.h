@@ -0,0 +1,135 @@
+#ifndef PRESSURE_SAMPLER_H
+#define PRESSURE_SAMPLER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Timer-driven pressure sensor sampler.
+// A FreeRTOS software timer reads the sensor at a fixed rate, independent of loop().
+// The SAADC oversamples in hardware, a slow moving average tracks the unloaded
+// baseline so sensor drift does not shift the thresholds, and two thresholds above
+// the baseline (press / release) give hysteresis. Only press and release events are
+// queued for loop(); between samples the CPU sleeps in the RTOS idle task.
+
+// Sampler configuration
+const uint32_t PRESSURE_SAMPLE_INTERVAL_MS = 20;      // 50 samples per second
+const uint8_t PRESSURE_OVERSAMPLING = 8;              // SAADC hardware oversampling
+const int PRESSURE_PRESS_DELTA = 600;                 // Counts above baseline to register a press (12-bit)
+const int PRESSURE_RELEASE_DELTA = 300;               // Counts above baseline to register a release
+const uint8_t PRESSURE_BASELINE_SHIFT = 7;            // Baseline follows 1/128 of each idle sample
+const uint32_t PRESSURE_MAX_PRESS_MS = 30000;         // Longer presses are treated as drift
+
+enum PressureEventType : uint8_t {
+  PRESSURE_PRESS = 0,
+  PRESSURE_RELEASE = 1
+};
+
+struct PressureEvent {
+  PressureEventType type;
+  uint16_t value;        // Sensor value that triggered the event
+  uint32_t timestamp;    // millis() of the sample
+  uint32_t duration;     // Press duration in ms (releases only)
+};
+
+// Event queue, written by the timer callback only and read by loop() only
+const uint8_t PRESSURE_QUEUE_SIZE = 16;  // Must be a power of two
+PressureEvent pressureQueue[PRESSURE_QUEUE_SIZE];
+std::atomic<uint8_t> pressureQueueHead(0);
+std::atomic<uint8_t> pressureQueueTail(0);
+std::atomic<uint32_t> pressureDroppedEvents(0);
+
+// Live values for the display
+std::atomic<uint16_t> pressureValue(0);
+std::atomic<uint16_t> pressureBaseline(0);
+
+// Detector state, owned by the timer callback
+SoftwareTimer pressureTimer;
+int pressurePin = A0;
+int32_t baselineAccumulator = 0;   // Baseline << PRESSURE_BASELINE_SHIFT
+bool pressureActive = false;
+uint32_t pressStartTime = 0;
+
+// Function to queue an event for loop()
+void queuePressureEvent(PressureEventType type, uint16_t value, uint32_t timestamp, uint32_t duration) {
+  uint8_t head = pressureQueueHead.load(std::memory_order_relaxed);
+  uint8_t next = (head + 1) & (PRESSURE_QUEUE_SIZE - 1);
+  if (next == pressureQueueTail.load(std::memory_order_acquire)) {
+    pressureDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  pressureQueue[head] = {type, value, timestamp, duration};
+  pressureQueueHead.store(next, std::memory_order_release);
+}
+
+// Timer callback - one sample through the detector
+void samplePressure(TimerHandle_t timer) {
+  uint32_t now = millis();
+  int value = analogRead(pressurePin);
+  int baseline = baselineAccumulator >> PRESSURE_BASELINE_SHIFT;
+  int delta = value - baseline;
+
+  if (!pressureActive) {
+    if (delta >= PRESSURE_PRESS_DELTA) {
+      pressureActive = true;
+      pressStartTime = now;
+      queuePressureEvent(PRESSURE_PRESS, value, now, 0);
+    } else {
+      // Only idle samples move the baseline, so a press cannot raise it
+      baselineAccumulator += value - baseline;
+    }
+  } else if (delta <= PRESSURE_RELEASE_DELTA) {
+    pressureActive = false;
+    queuePressureEvent(PRESSURE_RELEASE, value, now, now - pressStartTime);
+  } else if (now - pressStartTime >= PRESSURE_MAX_PRESS_MS) {
+    // Stuck above the threshold - adopt the current level as the new baseline
+    pressureActive = false;
+    baselineAccumulator = (int32_t)value << PRESSURE_BASELINE_SHIFT;
+    queuePressureEvent(PRESSURE_RELEASE, value, now, now - pressStartTime);
+  }
+
+  pressureValue.store(value, std::memory_order_relaxed);
+  pressureBaseline.store(baselineAccumulator >> PRESSURE_BASELINE_SHIFT, std::memory_order_relaxed);
+}
+
+// Function to get the next queued event, returns false if there is none
+bool nextPressureEvent(PressureEvent& event) {
+  uint8_t tail = pressureQueueTail.load(std::memory_order_relaxed);
+  if (tail == pressureQueueHead.load(std::memory_order_acquire)) {
+    return false;
+  }
+  event = pressureQueue[tail];
+  pressureQueueTail.store((tail + 1) & (PRESSURE_QUEUE_SIZE - 1), std::memory_order_release);
+  return true;
+}
+
+// Function to start sampling; the sensor must be unloaded for the initial baseline
+void setupPressureSampler(int pin) {
+  pressurePin = pin;
+  analogReadResolution(12);
+  analogOversampling(PRESSURE_OVERSAMPLING);
+
+  baselineAccumulator = (int32_t)analogRead(pressurePin) << PRESSURE_BASELINE_SHIFT;
+  pressureBaseline.store(baselineAccumulator >> PRESSURE_BASELINE_SHIFT);
+
+  pressureTimer.begin(PRESSURE_SAMPLE_INTERVAL_MS, samplePressure);
+  pressureTimer.start();
+}
+
+// Function to change the sample rate at runtime
+void setPressureSampleInterval(uint32_t intervalMs) {
+  pressureTimer.setPeriod(intervalMs);
+}
+
+uint16_t getPressureValue() {
+  return pressureValue.load(std::memory_order_relaxed);
+}
+
+uint16_t getPressureBaseline() {
+  return pressureBaseline.load(std::memory_order_relaxed);
+}
+
+uint32_t getPressureDroppedEvents() {
+  return pressureDroppedEvents.load(std::memory_order_relaxed);
+}
+
+#endif // PRESSURE_SAMPLER_H
@@ -1,6 +1,7 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "pressure_sampler.h"
 
 #define SCREEN_WIDTH 128 // OLED display width, in pixels
 #define SCREEN_HEIGHT 64 // OLED display height, in pixels. Some are 32.
@@ -18,9 +19,51 @@ const int ledPin = LED_BUILTIN;
 // Define the analog pin for the pressure sensor
 const int pressureSensorPin = A0;
 
-// Define a threshold for pressure detection (0-1023 for 10-bit ADC)
-// This value will likely need calibration based on your sensor and setup.
-const int pressureThreshold = 500; 
+// Press/release thresholds are set relative to a tracked baseline in pressure_sampler.h.
+// They will likely need calibration based on your sensor and setup.
+
+// Display refresh; loop() sleeps in between
+const unsigned long DISPLAY_INTERVAL = 200;  // milliseconds
+const int DISPLAY_MIN_CHANGE = 8;            // Redraw only if the value moved this much
+
+// Event counters shown on the OLED
+unsigned long pressCount = 0;
+unsigned long releaseCount = 0;
+uint32_t lastPressDuration = 0;
+int lastDisplayedValue = -1;
+bool displayDirty = true;
+
+// Function to draw the live value and event counts
+void updateDisplay() {
+  int value = getPressureValue();
+  if (!displayDirty && abs(value - lastDisplayedValue) < DISPLAY_MIN_CHANGE) {
+    return;
+  }
+  lastDisplayedValue = value;
+  displayDirty = false;
+
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setCursor(0, 0);
+  display.println(F("Pressure"));
+
+  display.setTextSize(2);
+  display.setCursor(0, 12);
+  display.println(value);
+
+  display.setTextSize(1);
+  display.setCursor(0, 34);
+  display.print(F("Base: "));
+  display.println(getPressureBaseline());
+  display.print(F("Presses: "));
+  display.println(pressCount);
+  display.print(F("Releases: "));
+  display.print(releaseCount);
+  display.print(F(" ("));
+  display.print(lastPressDuration);
+  display.println(F("ms)"));
+  display.display();
+}
 
 void setup() {
   Serial.begin(9600);
@@ -59,28 +102,35 @@ void setup() {
   pinMode(ledPin, OUTPUT);
   // Ensure LED is off initially
   digitalWrite(ledPin, HIGH); 
+
+  // Start timer-driven sampling (sensor must be unloaded to capture the baseline)
+  setupPressureSampler(pressureSensorPin);
+  Serial.println(F("Pressure sampler started"));
 }
 
 void loop() {
-  // Read the value from the pressure sensor
-  int sensorValue = analogRead(pressureSensorPin);
-
-  // Print the sensor value to the Serial Monitor for calibration
-  Serial.print("Sensor Value: ");
-  Serial.println(sensorValue);
-
-  // Check if force is applied (sensor value is above the threshold)
-  if (sensorValue > pressureThreshold) {
-    digitalWrite(ledPin, LOW);   // Turn the LED ON (remember, LOW is ON for this board's LED)
-    Serial.println("Pressure detected - LED ON");
-  } else {
-    digitalWrite(ledPin, HIGH);  // Turn the LED OFF
-    // Serial.println("No pressure - LED OFF"); // Optional: print when no pressure
+  // Handle press/release events queued by the sampler
+  PressureEvent event;
+  while (nextPressureEvent(event)) {
+    if (event.type == PRESSURE_PRESS) {
+      pressCount++;
+      digitalWrite(ledPin, LOW);   // Turn the LED ON (remember, LOW is ON for this board's LED)
+      Serial.print("Press: ");
+      Serial.println(event.value);
+    } else {
+      releaseCount++;
+      lastPressDuration = event.duration;
+      digitalWrite(ledPin, HIGH);  // Turn the LED OFF
+      Serial.print("Release after ");
+      Serial.print(event.duration);
+      Serial.println(" ms");
+    }
+    displayDirty = true;
   }
 
-  // Small delay to make Serial Monitor readable and debounce sensor a bit
-  delay(100);
+  updateDisplay();
 
-  // The OLED message is static, so nothing else to do in the loop for this example.
-  // You could add dynamic content here, like displaying the sensorValue.
+  // Sleep until the next display refresh; delay() blocks this task and the
+  // RTOS idle task puts the CPU to sleep until the sampling timer fires
+  delay(DISPLAY_INTERVAL);
 }